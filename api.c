@@ -9,14 +9,24 @@ to create a new api, functions needs to be created that do the following:
 - delete a file
 - create a directory
 - delete a directory
+- open a file and get its fd, and close it
+- write and read at a position
+- append and read at the stream position, and flush
+- write and read a list of buffers at a position. filesystems that can't
+  batch these can use writev_loop and readv_loop.
 
 once they have been created, a new API struct should be created with pointers 
-to these functions.
+to these functions. every function that goes to the filesystem should be
+wrapped in energy_storage_begin and energy_storage_end (see energy.c),
+with the bytes it wrote or read.
 
 at the bottom of this file is the init_api function, which sets everything up.
 any new apis created will also need to be added to the init_api function.
 */
 #include "api.h"
+#include "trace.h"
+#include "instrument.h"
+#include "compress.h"
 
 /*
 new_api is a constructor for the API struct. function pointers need to be set 
@@ -31,10 +41,18 @@ struct API* new_api(
         int(*open_get_fd_func)(char*),
         int(*write_at_func)(int, int, int, char*),
         int(*read_at_func)(int, int, int, char*),
-        int(*close_fd_func)(int)
+        int(*close_fd_func)(int),
+        int(*append_func)(int, int, char*),
+        int(*read_next_func)(int, int, char*),
+        int(*flush_func)(int),
+        int(*writev_at_func)(int, int, struct IOVec*, int),
+        int(*readv_at_func)(int, int, struct IOVec*, int),
+        int(*list_dir_func)(char*, void (*)(char*, void*), void*)
     ){
     void* t = malloc(sizeof(struct API));
     struct API* api_ptr = (struct API*)t;
+    api_ptr->name = "unnamed";
+    api_ptr->static_ram = 0;
     api_ptr->init = init_func;
     api_ptr->create_file = create_file_func;
     api_ptr->delete_file = delete_file_func;
@@ -44,6 +62,12 @@ struct API* new_api(
     api_ptr->write_at = write_at_func;
     api_ptr->read_at = read_at_func;
     api_ptr->close_fd = close_fd_func;
+    api_ptr->append = append_func;
+    api_ptr->read_next = read_next_func;
+    api_ptr->flush = flush_func;
+    api_ptr->writev_at = writev_at_func;
+    api_ptr->readv_at = readv_at_func;
+    api_ptr->list_dir = list_dir_func;
     return api_ptr;
 }
 
@@ -51,6 +75,40 @@ void free_api(struct API* api){
     free(api);
 }
 
+/*
+writev_loop is the fallback for vectored writes, it issues one write_at per
+buffer.
+*/
+int writev_loop(int (*write_at)(int, int, int, char*), int fd, int start_pos, struct IOVec* vec, int count){
+    for(int i = 0; i < count; i++){
+        if(write_at(fd, start_pos, vec[i].bytes, vec[i].buf) == -1){
+            return -1;
+        }
+        start_pos += vec[i].bytes;
+    }
+    return 0;
+}
+
+/*
+readv_loop is the fallback for vectored reads, it issues one read_at per
+buffer and stops at the end of the file. it returns the bytes read.
+*/
+int readv_loop(int (*read_at)(int, int, int, char*), int fd, int start_pos, struct IOVec* vec, int count){
+    int total = 0;
+    for(int i = 0; i < count; i++){
+        int got = read_at(fd, start_pos, vec[i].bytes, vec[i].buf);
+        if(got == -1){
+            return -1;
+        }
+        total += got;
+        if(got < vec[i].bytes){
+            break;
+        }
+        start_pos += got;
+    }
+    return total;
+}
+
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 CFS Functions
@@ -64,135 +122,481 @@ void cfs_init(){
 }
 
 int cfs_create_file(char* name){
+    energy_storage_begin();
     int fd = cfs_open(name, CFS_WRITE);
     if (fd == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
     cfs_close(fd);
 
+    energy_storage_end(0, 0);
     return fd;
 }
 
 int cfs_delete_file(char* name){
+    energy_storage_begin();
     int err = cfs_remove(name);
     if (err == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
 
+    energy_storage_end(0, 0);
     return 0;
 }
 
 int cfs_create_dir(char* name){
-    struct cfs_dir* dirp = NULL;
-    int err = cfs_opendir(dirp, name);
+    energy_storage_begin();
+    struct cfs_dir dir;
+    int err = cfs_opendir(&dir, name);
     if(err == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
-    cfs_closedir(dirp);
+    cfs_closedir(&dir);
+    energy_storage_end(0, 0);
     return 0;
 }
 
 int cfs_delete_dir(char* name){
+    energy_storage_begin();
     int err = cfs_remove(name);
     if (err == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
 
+    energy_storage_end(0, 0);
     return 0;
 }
 
 int cfs_open_get_fd(char* name){
-    return cfs_open(name, CFS_READ | CFS_APPEND);
+    energy_storage_begin();
+    int ret = cfs_open(name, CFS_READ | CFS_APPEND);
+    energy_storage_end(0, 0);
+    return ret;
 }
 
 int cfs_write_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
     cfs_seek(fd, start_pos, CFS_SEEK_SET);
-    cfs_write(fd, buf, bytes);
-    return 0;
+    int ret = cfs_write(fd, buf, bytes);
+    energy_storage_end((ret == -1) ? 0 : ret, 0);
+    return (ret == bytes) ? 0 : -1;
 }
 
 int cfs_read_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
     cfs_seek(fd, start_pos, CFS_SEEK_SET);
-    cfs_read(fd, buf, bytes);
-    return 0;
+    int ret = cfs_read(fd, buf, bytes);
+    energy_storage_end(0, (ret == -1) ? 0 : ret);
+    return ret;
 }
 
 int cfs_close_fd(int fd){
+    energy_storage_begin();
     cfs_close(fd);
+    energy_storage_end(0, 0);
     return 0;
 }
 
+int cfs_append(int fd, int bytes, char* buf){
+    energy_storage_begin();
+    int ret = cfs_write(fd, buf, bytes);
+    energy_storage_end((ret == -1) ? 0 : ret, 0);
+    return (ret == bytes) ? 0 : -1;
+}
+
+int cfs_read_next(int fd, int bytes, char* buf){
+    energy_storage_begin();
+    int ret = cfs_read(fd, buf, bytes);
+    energy_storage_end(0, (ret == -1) ? 0 : ret);
+    return ret;
+}
+
+/*
+cfs has no way to force data out, writes are handed to the filesystem
+immediately.
+*/
+int cfs_flush(int fd){
+    energy_storage_begin();
+    energy_storage_end(0, 0);
+    return 0;
+}
+
+// vectored io only seeks once, the buffers follow each other in the file
+int cfs_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    int total = 0;
+    energy_storage_begin();
+    cfs_seek(fd, start_pos, CFS_SEEK_SET);
+    for(int i = 0; i < count; i++){
+        int ret = cfs_write(fd, vec[i].buf, vec[i].bytes);
+        if(ret > 0){
+            total += ret;
+        }
+        if(ret != vec[i].bytes){
+            energy_storage_end(total, 0);
+            return -1;
+        }
+    }
+    energy_storage_end(total, 0);
+    return 0;
+}
+
+int cfs_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    int total = 0;
+    energy_storage_begin();
+    cfs_seek(fd, start_pos, CFS_SEEK_SET);
+    for(int i = 0; i < count; i++){
+        int got = cfs_read(fd, vec[i].buf, vec[i].bytes);
+        if(got > 0){
+            total += got;
+        }
+        if(got < vec[i].bytes){
+            break;
+        }
+    }
+    energy_storage_end(0, total);
+    return total;
+}
+
+/*
+list_cfs_dir walks a directory with cfs_readdir, coffee has the same
+calls. coffee is flat, every file is in the root.
+*/
+static int list_cfs_dir(char* name, void (*visit)(char*, void*), void* arg){
+    struct cfs_dir dir;
+    struct cfs_dirent entry;
+    int count = 0;
+    if(cfs_opendir(&dir, name) == -1){
+        return -1;
+    }
+    while(cfs_readdir(&dir, &entry) != -1){
+        visit(entry.name, arg);
+        count++;
+    }
+    cfs_closedir(&dir);
+    return count;
+}
+
+int cfs_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    energy_storage_begin();
+    int count = list_cfs_dir(name, visit, arg);
+    energy_storage_end(0, 0);
+    return count;
+}
+
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
 CoffeeFS Functions
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 struct API* Coffee; // Pointer to CFS API
 
+#define STAGING_SIZE 256
+static char staging[STAGING_SIZE]; // Gathers vectored io into larger cfs calls
+
 void coffee_init(){
     cfs_coffee_format();
 }
 
 int coffee_create_file(char* name){
     //log_info("create called.");
+    energy_storage_begin();
     int fd = cfs_open(name, CFS_WRITE);
     if (fd == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
     cfs_close(fd);
 
+    energy_storage_end(0, 0);
     return fd;
 }
 
 int coffee_delete_file(char* name){
     //log_info("delete called.");
+    energy_storage_begin();
     int err = cfs_remove(name);
     if (err == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
 
+    energy_storage_end(0, 0);
     return 0;
 }
 
 int coffee_create_dir(char* name){
     //log_info("create dir called.");
-    struct cfs_dir* dirp = NULL;
-    int err = cfs_opendir(dirp, name);
+    energy_storage_begin();
+    struct cfs_dir dir;
+    int err = cfs_opendir(&dir, name);
     if(err == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
-    cfs_closedir(dirp);
+    cfs_closedir(&dir);
+    energy_storage_end(0, 0);
     return 0;
 }
 
 int coffee_delete_dir(char* name){
     //log_info("delete dir called.");
+    energy_storage_begin();
     int err = cfs_remove(name);
     if (err == -1){
+        energy_storage_end(0, 0);
         return -1;
     }
 
+    energy_storage_end(0, 0);
     return 0;
 }
 
 int coffee_open_get_fd(char* name){
     //log_info("open called.");
-    return cfs_open(name, CFS_READ | CFS_WRITE | CFS_APPEND);
+    energy_storage_begin();
+    int ret = cfs_open(name, CFS_READ | CFS_WRITE | CFS_APPEND);
+    energy_storage_end(0, 0);
+    return ret;
 }
 
 int coffee_write_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
     cfs_seek(fd, start_pos, CFS_SEEK_SET);
-    cfs_write(fd, buf, bytes);
-    return 0;
+    int ret = cfs_write(fd, buf, bytes);
+    energy_storage_end((ret == -1) ? 0 : ret, 0);
+    return (ret == bytes) ? 0 : -1;
 }
 
 int coffee_read_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
     cfs_seek(fd, start_pos, CFS_SEEK_SET);
-    cfs_read(fd, buf, bytes);
-    return 0;
+    int ret = cfs_read(fd, buf, bytes);
+    energy_storage_end(0, (ret == -1) ? 0 : ret);
+    return ret;
 }
 
 int coffee_close_fd(int fd){
     //log_info("close called.");
+    energy_storage_begin();
     cfs_close(fd);
+    energy_storage_end(0, 0);
+    return 0;
+}
+
+int coffee_append(int fd, int bytes, char* buf){
+    energy_storage_begin();
+    int ret = cfs_write(fd, buf, bytes);
+    energy_storage_end((ret == -1) ? 0 : ret, 0);
+    return (ret == bytes) ? 0 : -1;
+}
+
+int coffee_read_next(int fd, int bytes, char* buf){
+    energy_storage_begin();
+    int ret = cfs_read(fd, buf, bytes);
+    energy_storage_end(0, (ret == -1) ? 0 : ret);
+    return ret;
+}
+
+/*
+coffee programs the flash (or its micro log) on every cfs_write, there is
+nothing buffered that a flush could write out.
+*/
+int coffee_flush(int fd){
+    energy_storage_begin();
+    energy_storage_end(0, 0);
+    return 0;
+}
+
+/*
+every cfs_write on coffee looks up the file and its micro log, so vectored
+writes are gathered into the staging buffer and written in as few calls as
+possible.
+*/
+int coffee_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int staged = 0;
+    int written = 0;
+    cfs_seek(fd, start_pos, CFS_SEEK_SET);
+    for(int i = 0; i < count; i++){
+        char* buf = vec[i].buf;
+        int bytes = vec[i].bytes;
+        while(bytes > 0){
+            int chunk = STAGING_SIZE - staged;
+            if(chunk > bytes){
+                chunk = bytes;
+            }
+            memcpy(staging + staged, buf, chunk);
+            staged += chunk;
+            buf += chunk;
+            bytes -= chunk;
+            if(staged == STAGING_SIZE){
+                if(cfs_write(fd, staging, staged) != staged){
+                    energy_storage_end(written, 0);
+                    return -1;
+                }
+                written += staged;
+                staged = 0;
+            }
+        }
+    }
+    if(staged > 0){
+        if(cfs_write(fd, staging, staged) != staged){
+            energy_storage_end(written, 0);
+            return -1;
+        }
+        written += staged;
+    }
+    energy_storage_end(written, 0);
+    return 0;
+}
+
+/*
+vectored reads fill the staging buffer with one cfs_read and scatter it
+into the buffers.
+*/
+int coffee_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int remaining = 0;
+    for(int i = 0; i < count; i++){
+        remaining += vec[i].bytes;
+    }
+    int total = remaining;
+    cfs_seek(fd, start_pos, CFS_SEEK_SET);
+    int i = 0;
+    int off = 0;
+    while(remaining > 0){
+        int got = cfs_read(fd, staging, (remaining < STAGING_SIZE) ? remaining : STAGING_SIZE);
+        if(got <= 0){
+            break;
+        }
+        remaining -= got;
+        int at = 0;
+        while(at < got){
+            int chunk = vec[i].bytes - off;
+            if(chunk > got - at){
+                chunk = got - at;
+            }
+            memcpy(vec[i].buf + off, staging + at, chunk);
+            at += chunk;
+            off += chunk;
+            if(off == vec[i].bytes){
+                i++;
+                off = 0;
+            }
+        }
+    }
+    energy_storage_end(0, total - remaining);
+    return total - remaining;
+}
+
+int coffee_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    energy_storage_begin();
+    int count = list_cfs_dir(name, visit, arg);
+    energy_storage_end(0, 0);
+    return count;
+}
+
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+LogFS Functions
+
+LogFS is the log-structured backend, its functions are in logfs.c
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+struct API* LogFS; // Pointer to LogFS API
+
+// appends already go through the logfs tail buffer, so the loop is enough
+// the energy accounting nests, so a vectored call counts as one operation
+int logfs_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int ret = writev_loop(logfs_write_at, fd, start_pos, vec, count);
+    energy_storage_end(0, 0);
+    return ret;
+}
+
+int logfs_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int ret = readv_loop(logfs_read_at, fd, start_pos, vec, count);
+    energy_storage_end(0, 0);
+    return ret;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Null Functions
+
+the null api does no io at all, every call returns as if it succeeded. a
+test run on it measures the harness alone (loops, dispatch and timing), which
+is the overhead included in the numbers of every other backend.
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+struct API* Null; // Pointer to Null API
+#ifdef WATZBENCH_HOST
+struct API* Posix; // Pointer to Posix API, the functions are in posix.c
+struct API* Ring; // Pointer to Ring API, the functions are in ring.c
+#endif
+
+void null_init(){
+
+}
+
+int null_create_file(char* name){
+    return 0;
+}
+
+int null_delete_file(char* name){
+    return 0;
+}
+
+int null_create_dir(char* name){
+    return 0;
+}
+
+int null_delete_dir(char* name){
+    return 0;
+}
+
+int null_open_get_fd(char* name){
+    return 0;
+}
+
+int null_write_at(int fd, int start_pos, int bytes, char* buf){
+    return 0;
+}
+
+// null reads claim every byte, like its writes, but leave buf as it is
+int null_read_at(int fd, int start_pos, int bytes, char* buf){
+    return bytes;
+}
+
+int null_close_fd(int fd){
+    return 0;
+}
+
+int null_append(int fd, int bytes, char* buf){
+    return 0;
+}
+
+int null_read_next(int fd, int bytes, char* buf){
+    return bytes;
+}
+
+int null_flush(int fd){
+    return 0;
+}
+
+int null_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    return 0;
+}
+
+int null_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    int total = 0;
+    for(int i = 0; i < count; i++){
+        total += vec[i].bytes;
+    }
+    return total;
+}
+
+int null_list_dir(char* name, void (*visit)(char*, void*), void* arg){
     return 0;
 }
 
@@ -206,6 +610,9 @@ The functions below are other misc functions needed by the API
 /*
 init_api is calle when the program starts. this is where we call the API 
 constructors for defined filesystems
+
+coffee's own file descriptors and caches live inside contiki, only the
+staging buffer is counted in its static_ram.
 */
 void init_api(){
     CFS = new_api(
@@ -217,8 +624,16 @@ void init_api(){
         cfs_open_get_fd,
         cfs_write_at,
         cfs_read_at,
-        cfs_close_fd
+        cfs_close_fd,
+        cfs_append,
+        cfs_read_next,
+        cfs_flush,
+        cfs_writev_at,
+        cfs_readv_at,
+        cfs_list_dir
         );
+    CFS->name = "CFS";
+    CFS->static_ram = 0;
 
     Coffee = new_api(
         coffee_init,
@@ -229,8 +644,161 @@ void init_api(){
         coffee_open_get_fd,
         coffee_write_at,
         coffee_read_at,
-        coffee_close_fd
+        coffee_close_fd,
+        coffee_append,
+        coffee_read_next,
+        coffee_flush,
+        coffee_writev_at,
+        coffee_readv_at,
+        coffee_list_dir
+        );
+    Coffee->name = "Coffee";
+    Coffee->static_ram = sizeof(staging);
+
+    LogFS = new_api(
+        logfs_init,
+        logfs_create_file,
+        logfs_delete_file,
+        logfs_create_dir,
+        logfs_delete_dir,
+        logfs_open_get_fd,
+        logfs_write_at,
+        logfs_read_at,
+        logfs_close_fd,
+        logfs_append,
+        logfs_read_next,
+        logfs_flush,
+        logfs_writev_at,
+        logfs_readv_at,
+        logfs_list_dir
+        );
+    LogFS->name = "LogFS";
+    LogFS->static_ram = logfs_static_ram();
+
+    Null = new_api(
+        null_init,
+        null_create_file,
+        null_delete_file,
+        null_create_dir,
+        null_delete_dir,
+        null_open_get_fd,
+        null_write_at,
+        null_read_at,
+        null_close_fd,
+        null_append,
+        null_read_next,
+        null_flush,
+        null_writev_at,
+        null_readv_at,
+        null_list_dir
+        );
+    Null->name = "Null";
+    Null->static_ram = 0;
+
+    Traced = new_api(
+        traced_init,
+        traced_create_file,
+        traced_delete_file,
+        traced_create_dir,
+        traced_delete_dir,
+        traced_open_get_fd,
+        traced_write_at,
+        traced_read_at,
+        traced_close_fd,
+        traced_append,
+        traced_read_next,
+        traced_flush,
+        traced_writev_at,
+        traced_readv_at,
+        traced_list_dir
+        );
+    Traced->name = "Traced";
+    Traced->static_ram = trace_static_ram();
+    trace_attach(Null);
+
+    Instrumented = new_api(
+        instrumented_init,
+        instrumented_create_file,
+        instrumented_delete_file,
+        instrumented_create_dir,
+        instrumented_delete_dir,
+        instrumented_open_get_fd,
+        instrumented_write_at,
+        instrumented_read_at,
+        instrumented_close_fd,
+        instrumented_append,
+        instrumented_read_next,
+        instrumented_flush,
+        instrumented_writev_at,
+        instrumented_readv_at,
+        instrumented_list_dir
+        );
+    Instrumented->name = "Instrumented";
+    Instrumented->static_ram = instrument_static_ram();
+    instrument_attach(Null);
+
+    Compressed = new_api(
+        compressed_init,
+        compressed_create_file,
+        compressed_delete_file,
+        compressed_create_dir,
+        compressed_delete_dir,
+        compressed_open_get_fd,
+        compressed_write_at,
+        compressed_read_at,
+        compressed_close_fd,
+        compressed_append,
+        compressed_read_next,
+        compressed_flush,
+        compressed_writev_at,
+        compressed_readv_at,
+        compressed_list_dir
+        );
+    Compressed->name = "Compressed";
+    Compressed->static_ram = compress_static_ram();
+    compress_attach(Null);
+
+#ifdef WATZBENCH_HOST
+    Posix = new_api(
+        posix_init,
+        posix_create_file,
+        posix_delete_file,
+        posix_create_dir,
+        posix_delete_dir,
+        posix_open_get_fd,
+        posix_write_at,
+        posix_read_at,
+        posix_close_fd,
+        posix_append,
+        posix_read_next,
+        posix_flush,
+        posix_writev_at,
+        posix_readv_at,
+        posix_list_dir
+        );
+    Posix->name = "Posix";
+    Posix->static_ram = posix_static_ram();
+
+    Ring = new_api(
+        ring_init,
+        posix_create_file,
+        posix_delete_file,
+        posix_create_dir,
+        posix_delete_dir,
+        ring_open_get_fd,
+        ring_write_at,
+        ring_read_at,
+        ring_close_fd,
+        ring_append,
+        ring_read_next,
+        ring_flush,
+        ring_writev_at,
+        ring_readv_at,
+        posix_list_dir
         );
+    Ring->name = "Ring";
+    Ring->static_ram = ring_static_ram();
+#endif
 }
 
 /*
@@ -240,4 +808,13 @@ destructors for defined filesystems
 void cleanup_api(){
     free_api(CFS);
     free_api(Coffee);
+    free_api(LogFS);
+    free_api(Null);
+    free_api(Traced);
+    free_api(Instrumented);
+    free_api(Compressed);
+#ifdef WATZBENCH_HOST
+    free_api(Posix);
+    free_api(Ring);
+#endif
 }
\ No newline at end of file
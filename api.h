@@ -11,10 +11,17 @@ additional information and descriptions are in the c file
 #define WATZBENCH_API_H
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <cfs/cfs.h>
 #include <cfs/cfs-coffee.h>
 
 #include "common.h"
+#include "energy.h"
+#include "logfs.h"
+#ifdef WATZBENCH_HOST
+#include "posix.h"
+#include "ring.h"
+#endif
 
 /*
 supported filesystems
@@ -24,12 +31,46 @@ to use it.
 */
 extern struct API* CFS;
 extern struct API* Coffee;
+extern struct API* LogFS;
+extern struct API* Null;
+#ifdef WATZBENCH_HOST
+extern struct API* Posix; // host build only
+extern struct API* Ring; // host build only
+#endif
+
+/*
+IOVec describes one buffer of a vectored write or read
+*/
+struct IOVec{
+    char* buf;
+    int bytes;
+};
 
 /*
 API is a struct that will control the interface with the underlying
 filesystem
+
+every fd has a stream position, like a contiki cfs fd. after open_get_fd
+it is at the end of the file, write_at and read_at leave it after the
+bytes they touched. append writes at the stream position and read_next
+reads from it, so neither of them seeks. read_at and read_next return
+the number of bytes read, which is short at the end of the file. flush
+returns once everything written to the fd is on flash.
+
+writev_at and readv_at move a list of buffers to or from one contiguous
+range of the file starting at a position. readv_at returns the bytes read
+like read_at.
+
+list_dir calls visit with the name of every file in a directory and the
+arg it was given, and returns how many there were. the flat backends only
+have the root, "/". a visit must not create or delete files.
+
+name and static_ram are set by init_api. static_ram is the ram the
+backend keeps in tables, buffers and caches on the watzbench side.
 */
 struct API{
+    char* name;
+    int static_ram;
     void (*init)();
     int (*create_file)(char*);
     int (*delete_file)(char*);
@@ -39,6 +80,12 @@ struct API{
     int (*write_at)(int, int, int, char*);
     int (*read_at)(int, int, int, char*);
     int (*close_fd)(int);
+    int (*append)(int, int, char*);
+    int (*read_next)(int, int, char*);
+    int (*flush)(int);
+    int (*writev_at)(int, int, struct IOVec*, int);
+    int (*readv_at)(int, int, struct IOVec*, int);
+    int (*list_dir)(char*, void (*)(char*, void*), void*);
 };
 
 struct API* new_api(
@@ -50,9 +97,99 @@ struct API* new_api(
     int (*open_get_fd)(char*),
     int (*write_at)(int, int, int, char*),
     int (*read_at)(int, int, int, char*),
-    int (*close_fd)(int)
+    int (*close_fd)(int),
+    int (*append)(int, int, char*),
+    int (*read_next)(int, int, char*),
+    int (*flush)(int),
+    int (*writev_at)(int, int, struct IOVec*, int),
+    int (*readv_at)(int, int, struct IOVec*, int),
+    int (*list_dir)(char*, void (*)(char*, void*), void*)
 );
 
+/*
+backend functions
+
+these are the functions the API structs point to. they are declared here so
+a static build (see API_CALL) can call them directly.
+*/
+void cfs_init();
+int cfs_create_file(char*);
+int cfs_delete_file(char*);
+int cfs_create_dir(char*);
+int cfs_delete_dir(char*);
+int cfs_open_get_fd(char*);
+int cfs_write_at(int, int, int, char*);
+int cfs_read_at(int, int, int, char*);
+int cfs_close_fd(int);
+int cfs_append(int, int, char*);
+int cfs_read_next(int, int, char*);
+int cfs_flush(int);
+int cfs_writev_at(int, int, struct IOVec*, int);
+int cfs_readv_at(int, int, struct IOVec*, int);
+int cfs_list_dir(char*, void (*)(char*, void*), void*);
+
+void coffee_init();
+int coffee_create_file(char*);
+int coffee_delete_file(char*);
+int coffee_create_dir(char*);
+int coffee_delete_dir(char*);
+int coffee_open_get_fd(char*);
+int coffee_write_at(int, int, int, char*);
+int coffee_read_at(int, int, int, char*);
+int coffee_close_fd(int);
+int coffee_append(int, int, char*);
+int coffee_read_next(int, int, char*);
+int coffee_flush(int);
+int coffee_writev_at(int, int, struct IOVec*, int);
+int coffee_readv_at(int, int, struct IOVec*, int);
+int coffee_list_dir(char*, void (*)(char*, void*), void*);
+
+int logfs_writev_at(int, int, struct IOVec*, int);
+int logfs_readv_at(int, int, struct IOVec*, int);
+
+void null_init();
+int null_create_file(char*);
+int null_delete_file(char*);
+int null_create_dir(char*);
+int null_delete_dir(char*);
+int null_open_get_fd(char*);
+int null_write_at(int, int, int, char*);
+int null_read_at(int, int, int, char*);
+int null_close_fd(int);
+int null_append(int, int, char*);
+int null_read_next(int, int, char*);
+int null_flush(int);
+int null_writev_at(int, int, struct IOVec*, int);
+int null_readv_at(int, int, struct IOVec*, int);
+int null_list_dir(char*, void (*)(char*, void*), void*);
+
+/*
+static dispatch
+
+tests call the api through API_CALL(api, fn)(args...). normally that is
+api->fn, an indirect call. building with -DWATZBENCH_STATIC_API=coffee
+(make STATIC_API=coffee) turns it into a direct call to coffee_fn, the api
+argument is then only used by run_test to check the test was given the
+backend the binary was built for. the prefix is one of cfs, coffee, logfs
+or null.
+*/
+#ifdef WATZBENCH_STATIC_API
+#define API_PASTE(prefix, fn) prefix ## _ ## fn
+#define API_STATIC(prefix, fn) API_PASTE(prefix, fn)
+#define API_CALL(api, fn) API_STATIC(WATZBENCH_STATIC_API, fn)
+#define API_BOUND(api) ((api)->write_at == API_STATIC(WATZBENCH_STATIC_API, write_at))
+#define API_STRING(prefix) #prefix
+#define API_NAME(prefix) API_STRING(prefix)
+#define API_DISPATCH "static " API_NAME(WATZBENCH_STATIC_API)
+#else
+#define API_CALL(api, fn) (api)->fn
+#define API_BOUND(api) 1
+#define API_DISPATCH "function pointers"
+#endif
+
+int writev_loop(int (*write_at)(int, int, int, char*), int, int, struct IOVec*, int);
+int readv_loop(int (*read_at)(int, int, int, char*), int, int, struct IOVec*, int);
+
 void free_api(struct API*);
 
 void init_api();
@@ -0,0 +1,333 @@
+/*
+archive.c keeps timestamped records in a file with a sparse time index
+next to it, and benchmarks time range queries with and without the index.
+
+an archive is two files on any backend. the data file holds fixed size
+records, each starting with its time (4 bytes, little endian). the index
+file gets an entry (the time and number of a record) for the first record
+of every ARCHIVE_INDEX_EVERY, so it is ARCHIVE_INDEX_EVERY times shorter
+than the data and sorted by time like it.
+
+a find for a time binary searches the index with one ARCHIVE_ENTRY read
+per probe, for the last entry at or before the time, then scans the data
+from that entry's record. without the index a find scans the data from
+the start. scans read buf_size bytes, several records, at a time. a query
+is a find for its start followed by a scan up to its end. the bytes every
+find and query read are added up in scanned, that is the scan cost, which
+on a node is radio-on time for whoever is waiting for the answer.
+
+records are written with write_at at the end of the data, so appends and
+queries can be mixed on the same fds. archive_open works out the length
+of archives that are already there from the index and the records after
+its last entry. api positions are ints, so neither file can grow past
+INT_MAX bytes, 32k on the msp430. an append that would is refused.
+
+the ArchiveQuery test writes a day of records, one per ARCHIVE_INTERVAL
+seconds with some jitter, and then times three kinds of queries with the
+index and with a linear scan. the day is cut short if its records don't
+fit in INT_MAX bytes (on the sky, 1023 records of 32 bytes, 17 hours at
+the default interval).
+ - point: the first record at or after a time, ARCHIVE_POINT_QUERIES of
+   them at minutes of the day following ACCESS_PATTERN
+ - recent: the last ARCHIVE_RECENT minutes of the day
+ - day: the whole day
+the latencies go into a histogram per kind and method, printed after the
+run with the bytes each query read on average. both methods have to find
+the same records, a difference is an error.
+*/
+#include <limits.h>
+#include "archive.h"
+#include "test.h"
+
+static void put32(unsigned char* p, unsigned long v){
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static unsigned long get32(unsigned char* p){
+    return p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static int read_entry(struct Archive* a, long n, unsigned long* time, long* record){
+    unsigned char entry[ARCHIVE_ENTRY];
+    int got = API_CALL(a->api, read_at)(a->index_fd, n * ARCHIVE_ENTRY, ARCHIVE_ENTRY, (char*)entry);
+    if(got != ARCHIVE_ENTRY){
+        return -1;
+    }
+    a->scanned += got;
+    *time = get32(entry);
+    *record = get32(entry + 4);
+    return 0;
+}
+
+/*
+archive_open opens or creates the archive in the files data and index.
+record_size is the size of every record, at least 4, and buf is scratch
+space of buf_size bytes, at least one record.
+*/
+int archive_open(struct Archive* a, struct API* api, char* data, char* index, int record_size, char* buf, int buf_size){
+    a->api = api;
+    a->record_size = record_size;
+    a->buf = buf;
+    a->buf_size = (buf_size / record_size) * record_size;
+    a->scanned = 0;
+    API_CALL(api, create_file)(data);
+    API_CALL(api, create_file)(index);
+    a->fd = API_CALL(api, open_get_fd)(data);
+    a->index_fd = API_CALL(api, open_get_fd)(index);
+    if(a->fd == -1 || a->index_fd == -1 || record_size < 4 || a->buf_size == 0){
+        log_error("archive: could not open");
+        return -1;
+    }
+    unsigned long time;
+    a->entries = 0;
+    a->records = 0;
+    while(read_entry(a, a->entries, &time, &a->records) == 0){
+        a->entries++;
+    }
+    if(a->entries == 0){
+        a->records = 0;
+    }
+    while(API_CALL(api, read_at)(a->fd, a->records * record_size, record_size, buf) == record_size){
+        a->records++;
+    }
+    a->scanned = 0;
+    return 0;
+}
+
+/*
+archive_append adds a record, its first 4 bytes are set to time. times
+have to be given in order.
+*/
+int archive_append(struct Archive* a, unsigned long time, char* record){
+    if(a->records >= INT_MAX / a->record_size || a->entries >= INT_MAX / ARCHIVE_ENTRY){
+        log_error("archive: full, a file would pass INT_MAX bytes");
+        return -1;
+    }
+    put32((unsigned char*)record, time);
+    if(API_CALL(a->api, write_at)(a->fd, a->records * a->record_size, a->record_size, record) == -1){
+        return -1;
+    }
+    if(a->records % ARCHIVE_INDEX_EVERY == 0){
+        unsigned char entry[ARCHIVE_ENTRY];
+        put32(entry, time);
+        put32(entry + 4, a->records);
+        if(API_CALL(a->api, write_at)(a->index_fd, a->entries * ARCHIVE_ENTRY, ARCHIVE_ENTRY, (char*)entry) == -1){
+            return -1;
+        }
+        a->entries++;
+    }
+    a->records++;
+    return 0;
+}
+
+/*
+scan reads records from first on and returns the number of the first
+one later than time (or at time, with inclusive set), or the number of
+records if there is none
+*/
+static long scan(struct Archive* a, long first, unsigned long time, int inclusive){
+    int per_read = a->buf_size / a->record_size;
+    for(long r = first; r < a->records; r += per_read){
+        int n = (a->records - r < per_read) ? a->records - r : per_read;
+        int got = API_CALL(a->api, read_at)(a->fd, r * a->record_size, n * a->record_size, a->buf);
+        if(got <= 0){
+            return a->records;
+        }
+        a->scanned += got;
+        for(int i = 0; i < got / a->record_size; i++){
+            unsigned long t = get32((unsigned char*)a->buf + i * a->record_size);
+            if(t > time || (inclusive && t == time)){
+                return r + i;
+            }
+        }
+    }
+    return a->records;
+}
+
+/*
+archive_find returns the number of the first record at or after time, or
+the number of records if there is none. indexed picks the index over a
+scan from the start.
+*/
+long archive_find(struct Archive* a, unsigned long time, int indexed){
+    long first = 0;
+    if(indexed){
+        long lo = 0;
+        long hi = a->entries - 1;
+        while(lo <= hi){
+            long mid = (lo + hi) / 2;
+            unsigned long t;
+            long record;
+            if(read_entry(a, mid, &t, &record) == -1){
+                break;
+            }
+            if(t < time){
+                first = record;
+                lo = mid + 1;
+            }else{
+                hi = mid - 1;
+            }
+        }
+    }
+    return scan(a, first, time, 1);
+}
+
+/*
+archive_query returns how many records there are from from to to, both
+included. the records pass through buf.
+*/
+long archive_query(struct Archive* a, unsigned long from, unsigned long to, int indexed){
+    long first = archive_find(a, from, indexed);
+    if(first >= a->records){
+        return 0;
+    }
+    return scan(a, first, to, 0) - first;
+}
+
+void archive_close(struct Archive* a){
+    API_CALL(a->api, close_fd)(a->fd);
+    API_CALL(a->api, close_fd)(a->index_fd);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ArchiveQuery Test
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define ARCHIVE_DAY 86400UL
+
+// Query kinds, each has a histogram per method
+#define ARCHIVE_POINT 0
+#define ARCHIVE_LAST 1
+#define ARCHIVE_WHOLE 2
+#define ARCHIVE_KINDS 3
+
+static const char* const kind_names[ARCHIVE_KINDS] = {"point", "recent", "day"};
+
+// per thread, so scale mode can run several archives at once
+static THREAD_LOCAL struct Archive archive;
+static THREAD_LOCAL unsigned long day;
+static THREAD_LOCAL unsigned long end_time;
+static THREAD_LOCAL unsigned long bytes[ARCHIVE_KINDS][2];
+static THREAD_LOCAL int disagreements;
+
+/*
+archive_prepare writes the day of records, the record buffer is followed
+by the scratch buffer
+*/
+int archive_prepare(struct Test* test){
+    // Null reads every record back, archive_open would never find the end
+    if(test->api == Null){
+        log_error("archive: Null stores nothing to query");
+        return -1;
+    }
+    int record = (RECORD_SIZE < 4) ? 4 : RECORD_SIZE;
+    int scratch = (BUFFER < record) ? record : BUFFER;
+    test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
+    name_files(test->params, 2);
+    void* t = arena_alloc(record + scratch);
+    test->params->buffer = (char*)t;
+    t = arena_alloc(sizeof(int) * ARCHIVE_POINT_QUERIES);
+    test->params->rands = (int*)t;
+    t = arena_alloc(sizeof(struct Histogram) * ARCHIVE_KINDS * 2);
+    test->params->hists = (struct Histogram*)t;
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
+    }
+    // the data and the index of the day have to stay below INT_MAX bytes
+    int interval = (ARCHIVE_INTERVAL < 1) ? 1 : ARCHIVE_INTERVAL;
+    int every = (ARCHIVE_INDEX_EVERY < 1) ? 1 : ARCHIVE_INDEX_EVERY;
+    unsigned long fit = INT_MAX / record;
+    if(fit > (unsigned long)(INT_MAX / ARCHIVE_ENTRY) * every){
+        fit = (unsigned long)(INT_MAX / ARCHIVE_ENTRY) * every;
+    }
+    fit *= interval;
+    day = (fit < ARCHIVE_DAY) ? fit : ARCHIVE_DAY;
+    if(day < ARCHIVE_DAY){
+        printf("archive: the day is cut to %lu s, its files can't pass INT_MAX bytes\n", day);
+    }
+    datagen_fill(test->params->buffer, record);
+    pattern_fill(test->params->rands, ARCHIVE_POINT_QUERIES, day / 60);
+    for(int i = 0; i < ARCHIVE_KINDS * 2; i++){
+        histogram_reset(&test->params->hists[i]);
+    }
+    for(int k = 0; k < ARCHIVE_KINDS; k++){
+        bytes[k][0] = 0;
+        bytes[k][1] = 0;
+    }
+    disagreements = 0;
+
+    if(archive_open(&archive, test->api, FILE_NAME(test->params, 0), FILE_NAME(test->params, 1),
+            record, test->params->buffer + record, scratch) == -1){
+        return -1;
+    }
+    pattern_seed(ACCESS_SEED + 2);
+    end_time = 0;
+    for(unsigned long time = 0; time < day; time += interval){
+        end_time = time + pattern_rand() % (interval / 4 + 1);
+        if(archive_append(&archive, end_time, test->params->buffer) == -1){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// timed_query runs one query with both methods
+static void timed_query(struct Test* test, int kind, unsigned long from, unsigned long to){
+    long found[2];
+    for(int indexed = 1; indexed >= 0; indexed--){
+        archive.scanned = 0;
+        rtimer_clock_t start = RTIMER_NOW();
+        if(kind == ARCHIVE_POINT){
+            found[indexed] = archive_find(&archive, from, indexed);
+        }else{
+            found[indexed] = archive_query(&archive, from, to, indexed);
+        }
+        histogram_add(&test->params->hists[kind * 2 + indexed], (rtimer_clock_t)(RTIMER_NOW() - start));
+        bytes[kind][indexed] += archive.scanned;
+    }
+    if(found[0] != found[1]){
+        disagreements++;
+    }
+}
+
+int archive_run(struct Test* test){
+    for(int i = 0; i < ARCHIVE_POINT_QUERIES; i++){
+        timed_query(test, ARCHIVE_POINT, test->params->rands[i] * 60UL, 0);
+    }
+    unsigned long recent = (unsigned long)ARCHIVE_RECENT * 60;
+    timed_query(test, ARCHIVE_LAST, (end_time > recent) ? end_time - recent : 0, end_time);
+    timed_query(test, ARCHIVE_WHOLE, 0, end_time);
+    return 0;
+}
+
+int archive_teardown(struct Test* test){
+    char label[20];
+    // a prepare that failed before its params has nothing to tear down
+    if(test->params == NULL){
+        return 0;
+    }
+    printf("archive: %ld records, %ld index entries\n", archive.records, archive.entries);
+    for(int k = 0; k < ARCHIVE_KINDS; k++){
+        for(int indexed = 1; indexed >= 0; indexed--){
+            struct Histogram* hist = &test->params->hists[k * 2 + indexed];
+            snprintf(label, sizeof(label), "%s %s", kind_names[k], indexed ? "indexed" : "linear");
+            histogram_print(hist, label);
+            if(hist->count > 0){
+                printf("%s: %lu bytes read per query\n", label, bytes[k][indexed] / hist->count);
+            }
+        }
+    }
+    if(disagreements > 0){
+        log_error("archive: indexed and linear queries found different records");
+    }
+    archive_close(&archive);
+    API_CALL(test->api, delete_file)(FILE_NAME(test->params, 0));
+    API_CALL(test->api, delete_file)(FILE_NAME(test->params, 1));
+    test->params = NULL;
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*
+archive.c keeps timestamped records in a file with a sparse time index
+next to it, and benchmarks time range queries with and without the index.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_ARCHIVE_H
+#define WATZBENCH_ARCHIVE_H
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "api.h"
+#include "common.h"
+
+// Bytes of an index entry: the time and the number of a record
+#define ARCHIVE_ENTRY 8
+
+// Point queries made by the ArchiveQuery test, with each method
+#define ARCHIVE_POINT_QUERIES 16
+
+/*
+Archive is an open archive. the first 4 bytes of every record are its
+time, little endian, the rest is the reading. buf is scratch space for
+scans, a whole number of records long.
+*/
+struct Archive{
+    struct API* api;
+    int fd;
+    int index_fd;
+    int record_size;
+    long records;
+    long entries;
+    char* buf;
+    int buf_size;
+    unsigned long scanned; // bytes read by finds and queries
+};
+
+extern int ARCHIVE_INTERVAL;
+extern int ARCHIVE_INDEX_EVERY;
+extern int ARCHIVE_RECENT;
+
+int archive_open(struct Archive*, struct API*, char* data, char* index, int record_size, char* buf, int buf_size);
+int archive_append(struct Archive*, unsigned long time, char* record);
+long archive_find(struct Archive*, unsigned long time, int indexed);
+long archive_query(struct Archive*, unsigned long from, unsigned long to, int indexed);
+void archive_close(struct Archive*);
+
+struct Test;
+
+int archive_prepare(struct Test* test);
+int archive_run(struct Test* test);
+int archive_teardown(struct Test* test);
+
+#endif //WATZBENCH_ARCHIVE_H
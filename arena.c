@@ -0,0 +1,60 @@
+/*
+arena.c is a fixed, static arena that test parameters and buffers are
+allocated from.
+
+allocations only move a pointer forward and are never freed one by one.
+run_test resets the arena before a test prepares, which releases
+everything the previous test allocated at once. the arena is a static
+array, so repeated runs can't fragment the heap, and a long sweep uses
+the same memory on its first test as on its last.
+
+the peak is the most the arena was asked for since the last reset. it
+includes requests that didn't fit, so a peak above ARENA_SIZE tells how
+large ARENA_CONF_SIZE needs to be.
+
+on the host build every thread has an arena of its own (see scale.c).
+*/
+#include <limits.h>
+#include "arena.h"
+
+// long keeps the arena aligned for any type the tests allocate
+static THREAD_LOCAL long arena[(ARENA_SIZE + sizeof(long) - 1) / sizeof(long)];
+static THREAD_LOCAL int used;
+static THREAD_LOCAL int peak;
+
+/*
+arena_alloc returns bytes from the arena, or NULL if they don't fit. the
+sum is worked out in a long, a request near INT_MAX would wrap an int (on
+the msp430 anything from 32k). a negative request is a size that already
+overflowed, it and anything too large for an int peak at INT_MAX.
+*/
+void* arena_alloc(int bytes){
+    long size = ((long)bytes + sizeof(long) - 1) / sizeof(long) * sizeof(long);
+    long want = (bytes < 0) ? INT_MAX : used + size;
+    if(want > INT_MAX){
+        want = INT_MAX;
+    }
+    if(want > peak){
+        peak = want;
+    }
+    if(want > ARENA_SIZE){
+        log_error("test arena is full");
+        return NULL;
+    }
+    void* p = (char*)arena + used;
+    used += size;
+    return p;
+}
+
+void arena_reset(){
+    used = 0;
+    peak = 0;
+}
+
+int arena_used(){
+    return used;
+}
+
+int arena_peak(){
+    return peak;
+}
@@ -0,0 +1,25 @@
+/*
+arena.c is the allocator used for everything a test needs while it runs.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_ARENA_H
+#define WATZBENCH_ARENA_H
+#include "contiki.h"
+
+#include "common.h"
+
+// Size of the arena, it can be overridden in project-conf.h
+#ifdef ARENA_CONF_SIZE
+#define ARENA_SIZE ARENA_CONF_SIZE
+#else
+#define ARENA_SIZE 4096
+#endif
+
+void* arena_alloc(int bytes);
+void arena_reset();
+int arena_used();
+int arena_peak();
+
+#endif //WATZBENCH_ARENA_H
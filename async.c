@@ -0,0 +1,228 @@
+/*
+async.c is a split-phase front end for the api. every api call blocks the
+calling protothread until the filesystem is done, which starves everything
+else on the node during large writes.
+
+with this front end a process queues an operation with async_submit and
+keeps going. async_process works through the queue in order, moving at
+most ASYNC_CHUNK bytes before it lets other processes run, and posts
+async_event_done to the submitting process when an operation completes.
+the queue holds ASYNC_QUEUE_SIZE operations, async_submit returns NULL when
+it is full.
+
+async_bench_process measures how much cpu a compute process gets while
+large writes are in progress, first with the blocking api and then with
+the split-phase one.
+*/
+#include "async.h"
+#include "test.h"
+
+#define SLOT_FREE 0
+#define SLOT_QUEUED 1
+#define SLOT_DONE 2
+
+process_event_t async_event_done;
+
+static struct AsyncOp queue[ASYNC_QUEUE_SIZE];
+static int queue_head; // next operation to carry out
+static int queue_tail; // next slot to hand out
+
+PROCESS(async_process, "Async io process");
+PROCESS(async_bench_process, "Async benchmark process");
+PROCESS(compute_process, "Compute process");
+
+/*
+init_async is called when the program starts
+*/
+void init_async(){
+    async_event_done = process_alloc_event();
+    process_start(&async_process, NULL);
+}
+
+/*
+async_submit queues an operation for the calling process. for ASYNC_FLUSH
+only the fd is used.
+*/
+struct AsyncOp* async_submit(struct API* api, unsigned char op, int fd, int start_pos, int bytes, char* buf){
+    struct AsyncOp* slot = &queue[queue_tail];
+    if(slot->state != SLOT_FREE){
+        return NULL;
+    }
+    slot->api = api;
+    slot->owner = PROCESS_CURRENT();
+    slot->op = op;
+    slot->fd = fd;
+    slot->start_pos = start_pos;
+    slot->bytes = bytes;
+    slot->buf = buf;
+    slot->done = 0;
+    slot->result = 0;
+    slot->state = SLOT_QUEUED;
+    queue_tail = (queue_tail + 1) % ASYNC_QUEUE_SIZE;
+    process_poll(&async_process);
+    return slot;
+}
+
+void async_release(struct AsyncOp* op){
+    op->state = SLOT_FREE;
+}
+
+/*
+async_step carries out the next chunk of an operation
+*/
+static void async_step(struct AsyncOp* op){
+    int chunk = op->bytes - op->done;
+    if(chunk > ASYNC_CHUNK){
+        chunk = ASYNC_CHUNK;
+    }
+    int err = 0;
+    switch(op->op){
+        case ASYNC_WRITE:
+            err = API_CALL(op->api, write_at)(op->fd, op->start_pos + op->done, chunk, op->buf + op->done);
+            break;
+        case ASYNC_READ:
+            err = API_CALL(op->api, read_at)(op->fd, op->start_pos + op->done, chunk, op->buf + op->done);
+            break;
+        case ASYNC_APPEND:
+            err = API_CALL(op->api, append)(op->fd, chunk, op->buf + op->done);
+            break;
+        case ASYNC_FLUSH:
+            err = API_CALL(op->api, flush)(op->fd);
+            chunk = op->bytes;
+            break;
+    }
+    if(err == -1){
+        op->result = -1;
+        chunk = op->bytes - op->done;
+    }
+    op->done += chunk;
+}
+
+PROCESS_THREAD(async_process, ev, data){
+    static struct AsyncOp* op;
+    PROCESS_BEGIN();
+    while(1){
+        PROCESS_YIELD_UNTIL(queue[queue_head].state == SLOT_QUEUED);
+        op = &queue[queue_head];
+        do{
+            async_step(op);
+            if(op->done < op->bytes){
+                // let everyone else run before the next chunk
+                process_poll(&async_process);
+                PROCESS_YIELD();
+            }
+        }while(op->done < op->bytes);
+        op->state = SLOT_DONE;
+        queue_head = (queue_head + 1) % ASYNC_QUEUE_SIZE;
+        process_post(op->owner, async_event_done, op);
+        if(queue[queue_head].state == SLOT_QUEUED){
+            process_poll(&async_process);
+        }
+    }
+    PROCESS_END();
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Benchmark
+
+async_bench_process is started with the api to test as its data. it writes
+ASYNC_PASSES blocks of WRITE_BYTES, each as a single operation, while
+compute_process counts how many units of work it gets done.
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#define ASYNC_PASSES 10
+#define WORK_LOOP 100 // iterations in one unit of compute work
+
+static unsigned long compute_work;
+
+PROCESS_THREAD(compute_process, ev, data){
+    PROCESS_BEGIN();
+    while(1){
+        for(volatile int i = 0; i < WORK_LOOP; i++);
+        compute_work++;
+        process_poll(&compute_process);
+        PROCESS_YIELD();
+    }
+    PROCESS_END();
+}
+
+PROCESS_THREAD(async_bench_process, ev, data){
+    static struct API* api;
+    static struct etimer et;
+    static char* buffer;
+    static int fd;
+    static int pass;
+    static int outstanding;
+    static clock_time_t start;
+    static unsigned long idle_work, idle_ticks;
+    static unsigned long blocking_work, blocking_ticks;
+    static unsigned long async_work, async_ticks;
+    PROCESS_BEGIN();
+    api = (struct API*)data;
+    if(!API_BOUND(api)){
+        log_error("this build is bound to another api (" API_DISPATCH ")");
+        PROCESS_EXIT();
+    }
+    API_CALL(api, init)();
+    arena_reset();
+    buffer = (char*)arena_alloc(WRITE_BYTES);
+    if(buffer == NULL){
+        printf("arena peak: %d of %d bytes\n", arena_peak(), ARENA_SIZE);
+        log_error("async: WRITE_BYTES does not fit in the arena");
+        PROCESS_EXIT();
+    }
+    datagen_fill(buffer, WRITE_BYTES);
+
+    // work the compute process gets done with the node otherwise idle
+    compute_work = 0;
+    process_start(&compute_process, NULL);
+    start = clock_time();
+    etimer_set(&et, CLOCK_SECOND / 2);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    idle_ticks = clock_time() - start;
+    idle_work = compute_work;
+
+    // blocking writes, this process does not yield until they are done
+    API_CALL(api, create_file)("WATZ");
+    fd = API_CALL(api, open_get_fd)("WATZ");
+    compute_work = 0;
+    start = clock_time();
+    for(pass = 0; pass < ASYNC_PASSES; pass++){
+        API_CALL(api, write_at)(fd, pass * WRITE_BYTES, WRITE_BYTES, buffer);
+    }
+    blocking_ticks = clock_time() - start;
+    blocking_work = compute_work;
+    API_CALL(api, close_fd)(fd);
+    API_CALL(api, delete_file)("WATZ");
+
+    // split-phase writes
+    API_CALL(api, create_file)("WATZ");
+    fd = API_CALL(api, open_get_fd)("WATZ");
+    compute_work = 0;
+    outstanding = 0;
+    start = clock_time();
+    pass = 0;
+    while(pass < ASYNC_PASSES || outstanding > 0){
+        if(pass < ASYNC_PASSES && async_submit(api, ASYNC_WRITE, fd, pass * WRITE_BYTES, WRITE_BYTES, buffer) != NULL){
+            pass++;
+            outstanding++;
+            continue;
+        }
+        PROCESS_WAIT_EVENT_UNTIL(ev == async_event_done);
+        async_release((struct AsyncOp*)data);
+        outstanding--;
+    }
+    async_ticks = clock_time() - start;
+    async_work = compute_work;
+    API_CALL(api, close_fd)(fd);
+    API_CALL(api, delete_file)("WATZ");
+
+    process_exit(&compute_process);
+    printf("async: idle %lu work in %lu ticks\n", idle_work, idle_ticks);
+    printf("async: blocking %lu work in %lu ticks\n", blocking_work, blocking_ticks);
+    printf("async: split-phase %lu work in %lu ticks\n", async_work, async_ticks);
+    if(idle_work > 0 && async_ticks > 0){
+        // share of the idle compute rate that was left during split-phase writes
+        printf("async: %lu%% cpu available\n", (async_work * idle_ticks * 100) / (idle_work * async_ticks));
+    }
+    PROCESS_END();
+}
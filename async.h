@@ -0,0 +1,61 @@
+/*
+async.c is a split-phase front end for the api. operations are queued and
+carried out by a separate process, the submitting process is told about
+completion through an event.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_ASYNC_H
+#define WATZBENCH_ASYNC_H
+#include "contiki.h"
+#include "api.h"
+#include "common.h"
+
+// Number of operations that can be queued at once
+#ifdef ASYNC_CONF_QUEUE_SIZE
+#define ASYNC_QUEUE_SIZE ASYNC_CONF_QUEUE_SIZE
+#else
+#define ASYNC_QUEUE_SIZE 4
+#endif
+
+// Bytes moved before the worker lets other processes run
+#ifdef ASYNC_CONF_CHUNK
+#define ASYNC_CHUNK ASYNC_CONF_CHUNK
+#else
+#define ASYNC_CHUNK 64
+#endif
+
+#define ASYNC_WRITE 0
+#define ASYNC_READ 1
+#define ASYNC_APPEND 2
+#define ASYNC_FLUSH 3
+
+/*
+AsyncOp is one queued operation. it is handed back as the data of the
+async_event_done event, and has to be given back with async_release once
+the owner is done with it.
+*/
+struct AsyncOp{
+    struct API* api;
+    struct process* owner;
+    unsigned char op;
+    unsigned char state;
+    int fd;
+    int start_pos;
+    int bytes;
+    char* buf;
+    int done;   // bytes completed so far
+    int result; // 0 or -1 once the operation completed
+};
+
+extern process_event_t async_event_done;
+
+PROCESS_NAME(async_process);
+PROCESS_NAME(async_bench_process);
+
+void init_async();
+struct AsyncOp* async_submit(struct API*, unsigned char op, int fd, int start_pos, int bytes, char* buf);
+void async_release(struct AsyncOp*);
+
+#endif //WATZBENCH_ASYNC_H
@@ -10,6 +10,13 @@ descriptions are in the c file.
 #define TRUE 1
 #define FALSE 0
 
+// state each thread of the host build's scaling mode has its own copy of
+#ifdef WATZBENCH_HOST
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
 extern const int DEBUGGING_ENABLED;
 
 void log_info(char*);
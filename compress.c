@@ -0,0 +1,432 @@
+/*
+compress.c is a compressing layer over any backend, for archival data.
+
+Compressed is a decorator api. compress_attach points it at a real
+backend. every write is compressed into blocks of at most COMPRESS_BLOCK
+bytes, and each block is appended to the file on the real backend as a
+COMPRESS_HEADER byte header (mode, raw length and stored length, 16 bit
+little endian) followed by the stored bytes. reads walk the headers to
+the block holding a position and decompress it.
+
+COMPRESS_MODE picks the compressor:
+ - COMPRESS_LZ: lzss with the block itself as the window, so it needs no
+   ram beyond the block. a flag byte says for each of the next 8 items
+   whether it is a literal byte or a match of two bytes, the distance
+   back (1 to 256) and the length (3 to 258).
+ - COMPRESS_DELTA: for time series. the block is read as 16 bit little
+   endian samples, each stored as the zigzag varint of its difference to
+   the one before. an odd last byte is stored as it is.
+a block that doesn't get smaller is stored as it is.
+
+the layer is for data that is only appended, like the archive: a write
+has to start at the end of the file, anything else fails. opening a file
+walks all of its headers to find its length, and so does every read, so
+reads get slower as a file grows. each write is compressed on its own, a
+file written in small records compresses worse than one written in large
+ones.
+
+the counts (bytes given, bytes stored including headers, blocks and the
+rtimer ticks spent compressing and decompressing) are reset before a test
+runs and printed after it, like instrument.c. the flash bytes, time and
+energy of the run are in the usual output, to compare with a run on the
+backend alone.
+*/
+#include "compress.h"
+
+struct API* Compressed; // Pointer to the Compressed API
+
+static struct API* target;
+
+// the real fd and the lengths of each open file, fd -1 is a free slot
+static struct{
+    int fd;
+    long logical; // bytes of data
+    long physical; // bytes on the backend
+    long pos; // stream position, in data bytes
+} files[COMPRESS_MAX_FDS];
+
+static unsigned char block[COMPRESS_BLOCK];
+static unsigned char packed[COMPRESS_HEADER + COMPRESS_BLOCK];
+
+static unsigned long raw_bytes;
+static unsigned long stored_bytes;
+static unsigned long blocks;
+static unsigned long cpu;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Compressors
+
+each encoder returns the stored length, or -1 if it would reach limit
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static int lz_encode(unsigned char* in, int n, unsigned char* out, int limit){
+    int i = 0;
+    int o = 0;
+    while(i < n){
+        if(o >= limit){
+            return -1;
+        }
+        int flag_at = o++;
+        unsigned char flags = 0;
+        for(int bit = 0; bit < 8 && i < n; bit++){
+            int best = 0;
+            int dist = 0;
+            for(int j = i - 1, tries = 0; j >= 0 && i - j <= 256 && tries < COMPRESS_LZ_SEARCH; j--, tries++){
+                int len = 0;
+                while(i + len < n && len < 258 && in[j + len] == in[i + len]){
+                    len++;
+                }
+                if(len > best){
+                    best = len;
+                    dist = i - j;
+                }
+            }
+            if(best >= 3){
+                if(o + 2 > limit){
+                    return -1;
+                }
+                out[o++] = dist - 1;
+                out[o++] = best - 3;
+                flags |= 1 << bit;
+                i += best;
+            }else{
+                if(o + 1 > limit){
+                    return -1;
+                }
+                out[o++] = in[i++];
+            }
+        }
+        out[flag_at] = flags;
+    }
+    return o;
+}
+
+static int lz_decode(unsigned char* in, int n, unsigned char* out, int raw){
+    int i = 0;
+    int o = 0;
+    while(i < n && o < raw){
+        unsigned char flags = in[i++];
+        for(int bit = 0; bit < 8 && i < n && o < raw; bit++){
+            if(flags & (1 << bit)){
+                if(i + 2 > n){
+                    return -1;
+                }
+                int dist = in[i] + 1;
+                int len = in[i + 1] + 3;
+                i += 2;
+                if(dist > o){
+                    return -1;
+                }
+                for(int k = 0; k < len && o < raw; k++, o++){
+                    out[o] = out[o - dist];
+                }
+            }else{
+                out[o++] = in[i++];
+            }
+        }
+    }
+    return (o == raw) ? 0 : -1;
+}
+
+static int delta_encode(unsigned char* in, int n, unsigned char* out, int limit){
+    unsigned short prev = 0;
+    int o = 0;
+    for(int i = 0; i + 1 < n; i += 2){
+        unsigned short sample = in[i] | (in[i + 1] << 8);
+        short d = (short)(sample - prev);
+        unsigned short z = ((unsigned short)d << 1) ^ (unsigned short)(d >> 15);
+        prev = sample;
+        while(z >= 0x80){
+            if(o >= limit){
+                return -1;
+            }
+            out[o++] = (z & 0x7F) | 0x80;
+            z >>= 7;
+        }
+        if(o >= limit){
+            return -1;
+        }
+        out[o++] = z;
+    }
+    if(n % 2 != 0){
+        if(o >= limit){
+            return -1;
+        }
+        out[o++] = in[n - 1];
+    }
+    return o;
+}
+
+static int delta_decode(unsigned char* in, int n, unsigned char* out, int raw){
+    unsigned short prev = 0;
+    int i = 0;
+    for(int o = 0; o + 1 < raw; o += 2){
+        unsigned short z = 0;
+        int shift = 0;
+        do{
+            if(i >= n || shift > 14){
+                return -1;
+            }
+            z |= (unsigned short)(in[i] & 0x7F) << shift;
+            shift += 7;
+        }while(in[i++] & 0x80);
+        short d = (short)((z >> 1) ^ -(z & 1));
+        prev = (unsigned short)(prev + d);
+        out[o] = prev & 0xFF;
+        out[o + 1] = prev >> 8;
+    }
+    if(raw % 2 != 0){
+        if(i >= n){
+            return -1;
+        }
+        out[raw - 1] = in[i];
+    }
+    return 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Blocks
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static int slot(int fd){
+    for(int i = 0; i < COMPRESS_MAX_FDS; i++){
+        if(files[i].fd == fd){
+            return i;
+        }
+    }
+    return -1;
+}
+
+// write_block compresses bytes of data into packed and appends it
+static int write_block(int s, unsigned char* data, int bytes){
+    rtimer_clock_t start = RTIMER_NOW();
+    int stored = -1;
+    unsigned char mode = COMPRESS_MODE;
+    if(mode == COMPRESS_LZ){
+        stored = lz_encode(data, bytes, packed + COMPRESS_HEADER, bytes - 1);
+    }else if(mode == COMPRESS_DELTA){
+        stored = delta_encode(data, bytes, packed + COMPRESS_HEADER, bytes - 1);
+    }
+    if(stored == -1){
+        mode = COMPRESS_STORE;
+        stored = bytes;
+        memcpy(packed + COMPRESS_HEADER, data, bytes);
+    }
+    packed[0] = mode;
+    packed[1] = bytes & 0xFF;
+    packed[2] = bytes >> 8;
+    packed[3] = stored & 0xFF;
+    packed[4] = stored >> 8;
+    cpu += (rtimer_clock_t)(RTIMER_NOW() - start);
+    int err = target->write_at(files[s].fd, files[s].physical, COMPRESS_HEADER + stored, (char*)packed);
+    if(err == -1){
+        return -1;
+    }
+    files[s].physical += COMPRESS_HEADER + stored;
+    files[s].logical += bytes;
+    raw_bytes += bytes;
+    stored_bytes += COMPRESS_HEADER + stored;
+    blocks++;
+    return 0;
+}
+
+/*
+read_header reads the header at phys, it returns -1 past the end. the
+length on the backend isn't known while a file is opened, so the header
+is read with read_next from phys, which says how much there was.
+*/
+static int read_header(int s, long phys, int* mode, int* raw, int* stored){
+    if(files[s].physical != -1 && phys + COMPRESS_HEADER > files[s].physical){
+        return -1;
+    }
+    if(target->read_at(files[s].fd, phys, 0, (char*)packed) == -1
+            || target->read_next(files[s].fd, COMPRESS_HEADER, (char*)packed) != COMPRESS_HEADER){
+        return -1;
+    }
+    *mode = packed[0];
+    *raw = packed[1] | (packed[2] << 8);
+    *stored = packed[3] | (packed[4] << 8);
+    return (*mode > COMPRESS_DELTA || *raw > COMPRESS_BLOCK || *stored > COMPRESS_BLOCK) ? -1 : 0;
+}
+
+// read_block decompresses the block at phys into block
+static int read_block(int s, long phys, int mode, int raw, int stored){
+    if(target->read_at(files[s].fd, phys + COMPRESS_HEADER, stored, (char*)packed) == -1){
+        return -1;
+    }
+    rtimer_clock_t start = RTIMER_NOW();
+    int err = 0;
+    if(mode == COMPRESS_LZ){
+        err = lz_decode(packed, stored, block, raw);
+    }else if(mode == COMPRESS_DELTA){
+        err = delta_decode(packed, stored, block, raw);
+    }else{
+        memcpy(block, packed, raw);
+    }
+    cpu += (rtimer_clock_t)(RTIMER_NOW() - start);
+    return err;
+}
+
+// read_data returns the data bytes read from pos, or -1
+static int read_data(int s, long pos, int bytes, char* buf){
+    long logical = 0;
+    long phys = 0;
+    int done = 0;
+    int mode, raw, stored;
+    while(done < bytes && read_header(s, phys, &mode, &raw, &stored) == 0){
+        if(pos + done < logical + raw){
+            if(read_block(s, phys, mode, raw, stored) == -1){
+                return -1;
+            }
+            int from = pos + done - logical;
+            int n = (raw - from < bytes - done) ? raw - from : bytes - done;
+            memcpy(buf + done, block + from, n);
+            done += n;
+        }
+        logical += raw;
+        phys += COMPRESS_HEADER + stored;
+    }
+    files[s].pos = pos + done;
+    return done;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Compressed Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/*
+compress_attach makes Compressed store its files on api
+*/
+void compress_attach(struct API* api){
+    target = api;
+}
+
+void compress_reset(){
+    raw_bytes = 0;
+    stored_bytes = 0;
+    blocks = 0;
+    cpu = 0;
+}
+
+void compress_print(){
+    if(blocks == 0){
+        return;
+    }
+    unsigned long permille = (raw_bytes == 0) ? 0 : (stored_bytes * 1000) / raw_bytes;
+    printf("compress: %lu bytes in %lu blocks stored as %lu (%lu.%lu%%), cpu %lu ticks\n",
+        raw_bytes, blocks, stored_bytes, permille / 10, permille % 10, cpu);
+}
+
+// the block buffers and the file table
+int compress_static_ram(){
+    return sizeof(block) + sizeof(packed) + sizeof(files);
+}
+
+void compressed_init(){
+    for(int i = 0; i < COMPRESS_MAX_FDS; i++){
+        files[i].fd = -1;
+    }
+    target->init();
+}
+
+int compressed_create_file(char* name){
+    return target->create_file(name);
+}
+
+int compressed_delete_file(char* name){
+    return target->delete_file(name);
+}
+
+int compressed_create_dir(char* name){
+    return target->create_dir(name);
+}
+
+int compressed_delete_dir(char* name){
+    return target->delete_dir(name);
+}
+
+// opening walks the headers to find the length of the data
+int compressed_open_get_fd(char* name){
+    int s = slot(-1);
+    if(s == -1){
+        log_error("compress: too many open files");
+        return -1;
+    }
+    int fd = target->open_get_fd(name);
+    if(fd == -1){
+        return -1;
+    }
+    files[s].fd = fd;
+    files[s].logical = 0;
+    files[s].physical = -1;
+    int mode, raw, stored;
+    long phys = 0;
+    while(read_header(s, phys, &mode, &raw, &stored) == 0){
+        files[s].logical += raw;
+        phys += COMPRESS_HEADER + stored;
+    }
+    files[s].physical = phys;
+    files[s].pos = files[s].logical;
+    return fd;
+}
+
+int compressed_write_at(int fd, int start_pos, int bytes, char* buf){
+    int s = slot(fd);
+    if(s == -1 || start_pos != files[s].logical){
+        log_error("compress: writes have to go to the end of the file");
+        return -1;
+    }
+    for(int at = 0; at < bytes; at += COMPRESS_BLOCK){
+        int n = (bytes - at < COMPRESS_BLOCK) ? bytes - at : COMPRESS_BLOCK;
+        if(write_block(s, (unsigned char*)buf + at, n) == -1){
+            return -1;
+        }
+    }
+    files[s].pos = files[s].logical;
+    return 0;
+}
+
+int compressed_read_at(int fd, int start_pos, int bytes, char* buf){
+    int s = slot(fd);
+    if(s == -1){
+        return -1;
+    }
+    return read_data(s, start_pos, bytes, buf);
+}
+
+int compressed_close_fd(int fd){
+    int s = slot(fd);
+    if(s != -1){
+        files[s].fd = -1;
+    }
+    return target->close_fd(fd);
+}
+
+int compressed_append(int fd, int bytes, char* buf){
+    int s = slot(fd);
+    if(s == -1){
+        return -1;
+    }
+    return compressed_write_at(fd, files[s].pos, bytes, buf);
+}
+
+int compressed_read_next(int fd, int bytes, char* buf){
+    int s = slot(fd);
+    if(s == -1){
+        return -1;
+    }
+    return read_data(s, files[s].pos, bytes, buf);
+}
+
+int compressed_flush(int fd){
+    return target->flush(fd);
+}
+
+int compressed_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    return writev_loop(compressed_write_at, fd, start_pos, vec, count);
+}
+
+int compressed_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    return readv_loop(compressed_read_at, fd, start_pos, vec, count);
+}
+
+int compressed_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    return target->list_dir(name, visit, arg);
+}
@@ -0,0 +1,71 @@
+/*
+compress.c is a compressing layer over any backend, for archival data
+that is only ever appended.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_COMPRESS_H
+#define WATZBENCH_COMPRESS_H
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "api.h"
+#include "common.h"
+
+// Most bytes compressed as one block, a larger write is split
+#ifdef COMPRESS_CONF_BLOCK
+#define COMPRESS_BLOCK COMPRESS_CONF_BLOCK
+#else
+#define COMPRESS_BLOCK 128
+#endif
+
+// Earlier positions the lz search tries for every byte
+#ifdef COMPRESS_CONF_LZ_SEARCH
+#define COMPRESS_LZ_SEARCH COMPRESS_CONF_LZ_SEARCH
+#else
+#define COMPRESS_LZ_SEARCH 32
+#endif
+
+// Files that can be open at once
+#ifdef COMPRESS_CONF_MAX_FDS
+#define COMPRESS_MAX_FDS COMPRESS_CONF_MAX_FDS
+#else
+#define COMPRESS_MAX_FDS 4
+#endif
+
+#if COMPRESS_BLOCK > 65535
+#error "a block length has to fit the 16 bit header fields"
+#endif
+
+// Modes for COMPRESS_MODE, also the first byte of every block
+#define COMPRESS_STORE 0 // kept as it is
+#define COMPRESS_LZ 1    // lzss within the block
+#define COMPRESS_DELTA 2 // 16 bit samples as zigzag varint deltas
+
+#define COMPRESS_HEADER 5 // mode, raw length, stored length
+
+extern int COMPRESS_MODE;
+extern struct API* Compressed;
+
+void compress_attach(struct API*);
+void compress_reset();
+void compress_print();
+int compress_static_ram();
+
+void compressed_init();
+int compressed_create_file(char*);
+int compressed_delete_file(char*);
+int compressed_create_dir(char*);
+int compressed_delete_dir(char*);
+int compressed_open_get_fd(char*);
+int compressed_write_at(int, int, int, char*);
+int compressed_read_at(int, int, int, char*);
+int compressed_close_fd(int);
+int compressed_append(int, int, char*);
+int compressed_read_next(int, int, char*);
+int compressed_flush(int);
+int compressed_writev_at(int, int, struct IOVec*, int);
+int compressed_readv_at(int, int, struct IOVec*, int);
+int compressed_list_dir(char*, void (*)(char*, void*), void*);
+
+#endif //WATZBENCH_COMPRESS_H
@@ -0,0 +1,353 @@
+/*
+console.c reads commands from the serial line, on hardware and on the
+native target (where the serial line is stdin).
+
+commands:
+ - help
+ - list: tests, backends and parameters with their values
+ - set PARAM value
+ - run Test Api
+ - repeat n Test Api
+ - sweep PARAM from to step Test Api: runs the test for every value from
+   from to to, adding step, or multiplying by n when step is xn. the
+   parameter is put back afterwards.
+ - async Api: the split-phase benchmark (see async.c)
+ - stats: logfs flash traffic since the last logfs init
+ - journal dump, journal clear (see journal.c)
+ - trace start Api: clears the trace and makes the Traced backend record
+   its calls and pass them on to Api
+ - trace dump, trace clear, trace load hex: a dump is the trace as load
+   commands (see trace.c)
+ - instrument Api: makes the Instrumented backend time every call and
+   pass it on to Api, a run on Instrumented prints the cost of each api
+   entry (see instrument.c)
+ - compress Api: makes the Compressed backend store its files on Api,
+   compressed following COMPRESS_MODE (see compress.c)
+ - trace replay Api [timed]: replays the trace at full speed as the
+   TraceReplay test, or with its original timing
+ - scale Test [threads]: host build only, runs copies of the test on
+   threads threads against Posix, or on 1 to the number of cores in turn
+   (see scale.c)
+ - quit: ends watzbench
+
+tests and parameters are named like the globals in the source, and
+backends by their api name.
+*/
+#include "console.h"
+#include "test.h"
+#include "params.h"
+#include "async.h"
+#include "journal.h"
+#include "trace.h"
+#include "instrument.h"
+#include "compress.h"
+#ifdef WATZBENCH_HOST
+#include "scale.h"
+#endif
+
+PROCESS(console_process, "Console process");
+
+struct TestEntry{
+    const char* name;
+    struct Test** test;
+};
+
+static const struct TestEntry tests[] = {
+    {"VerifyOpenUncached", &VerifyOpenUncached},
+    {"VerifyOpenCached", &VerifyOpenCached},
+    {"VerifyModifyInitial", &VerifyModifyInitial},
+    {"VerifyModifySub", &VerifyModifySub},
+    {"FileMetaDataCreate", &FileMetaDataCreate},
+    {"FileMetaDataDelete", &FileMetaDataDelete},
+    {"FileMetaDataOpen", &FileMetaDataOpen},
+    {"ThroughputSeqRead", &ThroughputSeqRead},
+    {"ThroughputSeqWrite", &ThroughputSeqWrite},
+    {"ThroughputRandRead", &ThroughputRandRead},
+    {"ThroughputRandWrite", &ThroughputRandWrite},
+    {"ThroughputStreamRead", &ThroughputStreamRead},
+    {"ThroughputStreamWrite", &ThroughputStreamWrite},
+    {"DurabilityFlush", &DurabilityFlush},
+    {"BatchRecordWrite", &BatchRecordWrite},
+    {"BatchRecordRead", &BatchRecordRead},
+    {"MixedWorkload", &MixedWorkload},
+    {"SensorIngest", &SensorIngest},
+    {"TraceReplay", &TraceReplay},
+    {"DirList", &DirList},
+    {"DirFind", &DirFind},
+    {"DirDelete", &DirDelete},
+    {"ArchivalStorage", &ArchivalStorage},
+    {"ArchiveQuery", &ArchiveQuery},
+#ifdef WATZBENCH_ANTELOPE
+    {"DbInsert", &DbInsert},
+    {"DbSelect", &DbSelect},
+    {"DbRange", &DbRange},
+    {"DbDelete", &DbDelete},
+#endif
+};
+
+#define TEST_COUNT (sizeof(tests) / sizeof(struct TestEntry))
+
+static struct API** const apis[] = {
+    &CFS, &Coffee, &LogFS, &Null, &Traced, &Instrumented, &Compressed,
+#ifdef WATZBENCH_HOST
+    &Posix, &Ring,
+#endif
+};
+
+#define API_COUNT (sizeof(apis) / sizeof(struct API**))
+
+static char line[CONSOLE_LINE_SIZE];
+static char* argv[CONSOLE_MAX_ARGS];
+static int argc;
+
+// split line into argv on spaces
+static void split(){
+    char* p = line;
+    argc = 0;
+    while(*p != '\0' && argc < CONSOLE_MAX_ARGS){
+        while(*p == ' '){
+            *p++ = '\0';
+        }
+        if(*p == '\0'){
+            break;
+        }
+        argv[argc++] = p;
+        while(*p != ' ' && *p != '\0'){
+            p++;
+        }
+    }
+}
+
+static struct Test* find_test(char* name){
+    for(int i = 0; i < TEST_COUNT; i++){
+        if(strcmp(tests[i].name, name) == 0){
+            return *tests[i].test;
+        }
+    }
+    printf("unknown test %s\n", name);
+    return NULL;
+}
+
+static struct API* find_api(char* name){
+    for(int i = 0; i < API_COUNT; i++){
+        if(strcmp((*apis[i])->name, name) == 0){
+            return *apis[i];
+        }
+    }
+    printf("unknown backend %s\n", name);
+    return NULL;
+}
+
+static const struct Param* find_param(char* name){
+    const struct Param* param = param_find(name);
+    if(param == NULL){
+        printf("unknown parameter %s\n", name);
+    }
+    return param;
+}
+
+// every result line of a run is preceded by what was run
+static void run(struct API* api, struct Test* test){
+    printf("run: %s on %s\n", test->name, api->name);
+    run_test(api, test);
+}
+
+static void list(){
+    printf("tests:");
+    for(int i = 0; i < TEST_COUNT; i++){
+        printf(" %s", tests[i].name);
+    }
+    printf("\nbackends:");
+    for(int i = 0; i < API_COUNT; i++){
+        printf(" %s", (*apis[i])->name);
+    }
+    printf("\nparameters:\n");
+    for(int i = 0; i < PARAM_COUNT; i++){
+        param_print(&PARAMS[i]);
+    }
+}
+
+static void help(){
+    printf("commands:\n");
+    printf(" list\n");
+    printf(" set PARAM value\n");
+    printf(" run Test Api\n");
+    printf(" repeat n Test Api\n");
+    printf(" sweep PARAM from to step|xn Test Api\n");
+    printf(" async Api\n");
+    printf(" stats\n");
+    printf(" journal dump|clear\n");
+    printf(" trace start Api|dump|clear|load hex\n");
+    printf(" trace replay Api [timed]\n");
+    printf(" instrument Api\n");
+    printf(" compress Api\n");
+#ifdef WATZBENCH_HOST
+    printf(" scale Test [threads]\n");
+#endif
+    printf(" quit\n");
+}
+
+// parse_int reads a whole decimal argument that fits an int
+static int parse_int(char* arg, int* value){
+    char* end;
+    long v = strtol(arg, &end, 10);
+    if(end == arg || *end != '\0' || v < INT_MIN || v > INT_MAX){
+        printf("%s is not a number\n", arg);
+        return -1;
+    }
+    *value = (int)v;
+    return 0;
+}
+
+/*
+sweep runs a test for every value of a parameter from from to to, adding
+step or multiplying by it (xn). the next value is only worked out if it
+doesn't pass to, so the last step can't overflow an int.
+*/
+static void sweep(const struct Param* param, char* from_arg, char* to_arg, char* step, struct Test* test, struct API* api){
+    int from, to, by;
+    int multiply = (step[0] == 'x');
+    if(parse_int(from_arg, &from) == -1 || parse_int(to_arg, &to) == -1
+            || parse_int(multiply ? step + 1 : step, &by) == -1){
+        return;
+    }
+    if(param_check(param, from) == -1 || param_check(param, to) == -1){
+        return;
+    }
+    if(by <= 0 || (multiply && by == 1)){
+        printf("step has to make progress\n");
+        return;
+    }
+    if(multiply && from <= 0){
+        printf("a multiplying sweep has to start above 0\n");
+        return;
+    }
+    int saved = *param->value;
+    for(int value = from; value <= to; value = multiply ? value * by : value + by){
+        *param->value = value;
+        printf("sweep: %s = %d\n", param->name, value);
+        run(api, test);
+        if(multiply ? value > to / by : value > to - by){
+            break;
+        }
+    }
+    *param->value = saved;
+}
+
+PROCESS_THREAD(console_process, ev, data){
+    static struct API* api;
+    PROCESS_BEGIN();
+    // the journal records tests by the name they are run by
+    for(int i = 0; i < TEST_COUNT; i++){
+        (*tests[i].test)->id = tests[i].name;
+    }
+    printf("type help for commands\n");
+    while(1){
+        PROCESS_WAIT_EVENT_UNTIL(ev == serial_line_event_message);
+        strncpy(line, (char*)data, sizeof(line) - 1);
+        line[sizeof(line) - 1] = '\0';
+        split();
+        if(argc == 0){
+            continue;
+        }
+        const struct Param* param;
+        struct Test* test;
+        if(strcmp(argv[0], "help") == 0){
+            help();
+        }else if(strcmp(argv[0], "list") == 0){
+            list();
+        }else if(strcmp(argv[0], "set") == 0 && argc == 3){
+            int value;
+            if((param = find_param(argv[1])) != NULL && parse_int(argv[2], &value) != -1
+                    && param_check(param, value) != -1){
+                *param->value = value;
+                param_print(param);
+            }
+        }else if(strcmp(argv[0], "run") == 0 && argc == 3){
+            if((test = find_test(argv[1])) != NULL && (api = find_api(argv[2])) != NULL){
+                run(api, test);
+            }
+        }else if(strcmp(argv[0], "repeat") == 0 && argc == 4){
+            int times;
+            if(parse_int(argv[1], &times) != -1 && (test = find_test(argv[2])) != NULL
+                    && (api = find_api(argv[3])) != NULL){
+                if(times < 1){
+                    printf("times has to be at least 1\n");
+                }
+                for(; times > 0; times--){
+                    run(api, test);
+                }
+            }
+        }else if(strcmp(argv[0], "sweep") == 0 && argc == 7){
+            if((param = find_param(argv[1])) != NULL && (test = find_test(argv[5])) != NULL
+                    && (api = find_api(argv[6])) != NULL){
+                sweep(param, argv[2], argv[3], argv[4], test, api);
+            }
+        }else if(strcmp(argv[0], "async") == 0 && argc == 2){
+            if((api = find_api(argv[1])) != NULL){
+                process_start(&async_bench_process, (void*)api);
+                // it exits straight away if it does not fit in the arena
+                if(process_is_running(&async_bench_process)){
+                    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_EXITED && data == &async_bench_process);
+                }
+            }
+        }else if(strcmp(argv[0], "stats") == 0){
+            logfs_print_stats();
+        }else if(strcmp(argv[0], "journal") == 0 && argc == 2 && strcmp(argv[1], "dump") == 0){
+            journal_dump();
+        }else if(strcmp(argv[0], "journal") == 0 && argc == 2 && strcmp(argv[1], "clear") == 0){
+            journal_clear();
+        }else if(strcmp(argv[0], "instrument") == 0 && argc == 2){
+            if((api = find_api(argv[1])) != NULL && api != Instrumented){
+                instrument_attach(api);
+            }
+        }else if(strcmp(argv[0], "compress") == 0 && argc == 2){
+            if((api = find_api(argv[1])) != NULL && api != Compressed){
+                compress_attach(api);
+            }
+        }else if(strcmp(argv[0], "trace") == 0 && argc == 3 && strcmp(argv[1], "start") == 0){
+            if((api = find_api(argv[2])) != NULL && api != Traced){
+                trace_attach(api);
+                trace_clear();
+            }
+        }else if(strcmp(argv[0], "trace") == 0 && argc == 2 && strcmp(argv[1], "dump") == 0){
+            trace_dump();
+        }else if(strcmp(argv[0], "trace") == 0 && argc == 2 && strcmp(argv[1], "clear") == 0){
+            trace_clear();
+        }else if(strcmp(argv[0], "trace") == 0 && argc == 3 && strcmp(argv[1], "load") == 0){
+            if(trace_load(argv[2]) == -1){
+                printf("not hex, or the trace is full\n");
+            }
+        }else if(strcmp(argv[0], "trace") == 0 && (argc == 3 || argc == 4) && strcmp(argv[1], "replay") == 0){
+            if((api = find_api(argv[2])) != NULL && api != Traced){
+                if(argc == 4 && strcmp(argv[3], "timed") == 0){
+                    process_start(&trace_replay_process, (void*)api);
+                    if(process_is_running(&trace_replay_process)){
+                        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_EXITED && data == &trace_replay_process);
+                    }
+                }else{
+                    run(api, TraceReplay);
+                }
+            }
+#ifdef WATZBENCH_HOST
+        }else if(strcmp(argv[0], "scale") == 0 && (argc == 2 || argc == 3)){
+            int threads;
+            if((test = find_test(argv[1])) != NULL){
+                if(argc == 3){
+                    if(parse_int(argv[2], &threads) != -1){
+                        scale_run(test, threads);
+                    }
+                }else{
+                    scale_sweep(test);
+                }
+            }
+#endif
+        }else if(strcmp(argv[0], "quit") == 0){
+            PROCESS_EXIT();
+        }else{
+            printf("unknown command, type help for commands\n");
+        }
+        printf("ok\n");
+    }
+    PROCESS_END();
+}
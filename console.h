@@ -0,0 +1,24 @@
+/*
+console.c is the serial line interface of watzbench, it selects tests,
+backends and parameters at runtime.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_CONSOLE_H
+#define WATZBENCH_CONSOLE_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "contiki.h"
+#include "dev/serial-line.h"
+
+#include "common.h"
+
+// Longest command line and most words in it
+#define CONSOLE_LINE_SIZE 80
+#define CONSOLE_MAX_ARGS 8
+
+PROCESS_NAME(console_process);
+
+#endif //WATZBENCH_CONSOLE_H
@@ -0,0 +1,198 @@
+/*
+database.c runs workloads on the Antelope database that comes with
+contiki, to compare against the same data kept in plain files. it is
+only built with make ANTELOPE=1, which adds the antelope app.
+
+antelope keeps its relations and indexes in cfs files, which on the
+nodes is Coffee, so the tests only run on Coffee. they use a relation of
+DB_ROWS sensor samples, a time (LONG, one per minute, indexed with
+DATABASE_INDEX) and a value (INT):
+ - DbInsert: inserts the rows one INSERT at a time
+ - DbSelect: DATABASE_QUERIES selects of a single time, at minutes
+   following ACCESS_PATTERN
+ - DbRange: DATABASE_QUERIES selects of DB_RANGE minutes each
+ - DbDelete: removes the rows in DATABASE_QUERIES steps, oldest first
+the latency of every statement goes into a histogram printed after the
+run. statements are wrapped in energy_storage_begin/end like the api
+calls of the file tests, so timing and energy are reported the same way.
+the files to compare with are SensorIngest for inserts and ArchiveQuery
+(archive.c) for selects.
+
+a select that returns a different number of rows than there are in its
+range is an error.
+*/
+#include "database.h"
+
+#ifdef WATZBENCH_ANTELOPE
+#include <stdarg.h>
+#include "antelope.h"
+#include "test.h"
+
+static char query[DATABASE_QUERY_SIZE]; // the statement, formatted before it is timed
+static int ready;
+static unsigned long wrong_rows;
+
+// run_query runs the statement in query to the end, it returns the rows it produced or -1
+static long run_query(){
+    db_handle_t handle;
+    long rows = 0;
+    energy_storage_begin();
+    db_result_t result = db_query(&handle, "%s", query);
+    if(DB_SUCCESS(result) && db_processing(&handle)){
+        while(db_processing(&handle)){
+            result = db_process(&handle);
+            if(result == DB_GOT_ROW){
+                rows++;
+            }else if(result == DB_FINISHED || DB_ERROR(result)){
+                break;
+            }
+        }
+        db_free(&handle);
+    }
+    energy_storage_end(0, 0);
+    if(DB_ERROR(result)){
+        printf("database: %s: %s\n", query, db_get_result_message(result));
+        return -1;
+    }
+    return rows;
+}
+
+static long exec(const char* format, ...){
+    va_list args;
+    va_start(args, format);
+    vsnprintf(query, sizeof(query), format, args);
+    va_end(args);
+    return run_query();
+}
+
+// timed_exec is exec, with the latency added to the histogram of the test
+static long timed_exec(struct Test* test, const char* format, ...){
+    va_list args;
+    va_start(args, format);
+    vsnprintf(query, sizeof(query), format, args);
+    va_end(args);
+    rtimer_clock_t start = RTIMER_NOW();
+    long rows = run_query();
+    histogram_add(&test->params->hists[0], (rtimer_clock_t)(RTIMER_NOW() - start));
+    return rows;
+}
+
+/*
+database_insert_prepare creates the empty relation and its index
+*/
+int database_insert_prepare(struct Test* test){
+    ready = 0;
+    wrong_rows = 0;
+    test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
+    void* t = arena_alloc(sizeof(int) * DATABASE_QUERIES);
+    test->params->rands = (int*)t;
+    t = arena_alloc(sizeof(struct Histogram));
+    test->params->hists = (struct Histogram*)t;
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
+    }
+    if(test->api != Coffee){
+        log_error("database: antelope stores its relations through cfs, run it on Coffee");
+        return -1;
+    }
+    histogram_reset(&test->params->hists[0]);
+    pattern_fill(test->params->rands, DATABASE_QUERIES, DB_ROWS);
+    db_init();
+    if(exec("CREATE RELATION samples;") == -1
+            || exec("CREATE ATTRIBUTE time DOMAIN LONG IN samples;") == -1
+            || exec("CREATE ATTRIBUTE value DOMAIN INT IN samples;") == -1
+            || exec("CREATE INDEX samples.time TYPE %s;", DATABASE_INDEX) == -1){
+        return -1;
+    }
+    ready = 1;
+    return 0;
+}
+
+int database_insert_run(struct Test* test){
+    if(!ready){
+        return -1;
+    }
+    for(long row = 0; row < DB_ROWS; row++){
+        if(timed_exec(test, "INSERT (%ld, %d) INTO samples;", row * 60, (int)(2048 + row % 64)) == -1){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+database_filled_prepare creates the relation and inserts the rows
+*/
+int database_filled_prepare(struct Test* test){
+    if(database_insert_prepare(test) == -1){
+        return -1;
+    }
+    ready = 0;
+    for(long row = 0; row < DB_ROWS; row++){
+        if(exec("INSERT (%ld, %d) INTO samples;", row * 60, (int)(2048 + row % 64)) == -1){
+            return -1;
+        }
+    }
+    ready = 1;
+    return 0;
+}
+
+int database_select_run(struct Test* test){
+    if(!ready){
+        return -1;
+    }
+    for(int i = 0; i < DATABASE_QUERIES; i++){
+        long time = test->params->rands[i] * 60L;
+        if(timed_exec(test, "SELECT value FROM samples WHERE time = %ld;", time) != 1){
+            wrong_rows++;
+        }
+    }
+    return 0;
+}
+
+int database_range_run(struct Test* test){
+    if(!ready){
+        return -1;
+    }
+    for(int i = 0; i < DATABASE_QUERIES; i++){
+        long first = test->params->rands[i];
+        long last = (first + DB_RANGE > DB_ROWS) ? DB_ROWS : first + DB_RANGE;
+        long rows = timed_exec(test, "SELECT time, value FROM samples WHERE time >= %ld AND time < %ld;",
+            first * 60, last * 60);
+        if(rows != last - first){
+            wrong_rows++;
+        }
+    }
+    return 0;
+}
+
+int database_delete_run(struct Test* test){
+    if(!ready){
+        return -1;
+    }
+    for(int i = 1; i <= DATABASE_QUERIES; i++){
+        long cut = ((long)DB_ROWS * i) / DATABASE_QUERIES;
+        if(timed_exec(test, "REMOVE FROM samples WHERE time < %ld;", cut * 60) == -1){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int database_teardown(struct Test* test){
+    if(ready){
+        histogram_print(&test->params->hists[0], "statement");
+        exec("REMOVE RELATION samples;");
+    }
+    if(wrong_rows > 0){
+        printf("database: %lu selects returned the wrong number of rows\n", wrong_rows);
+        log_error("database: wrong select results");
+    }
+    ready = 0;
+    test->params = NULL;
+    return 0;
+}
+#endif
@@ -0,0 +1,44 @@
+/*
+database.c runs workloads on the Antelope database that comes with
+contiki, to compare against the same data kept in plain files. it is
+only built with make ANTELOPE=1.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_DATABASE_H
+#define WATZBENCH_DATABASE_H
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "api.h"
+#include "common.h"
+
+// Index antelope keeps on the time attribute
+#ifdef DATABASE_CONF_INDEX
+#define DATABASE_INDEX DATABASE_CONF_INDEX
+#else
+#define DATABASE_INDEX "maxheap"
+#endif
+
+// Selects made by the select tests, and steps the delete test takes
+#define DATABASE_QUERIES 16
+
+// Longest query text
+#define DATABASE_QUERY_SIZE 96
+
+extern int DB_ROWS;
+extern int DB_RANGE;
+
+#ifdef WATZBENCH_ANTELOPE
+struct Test;
+
+int database_insert_prepare(struct Test* test);
+int database_insert_run(struct Test* test);
+int database_filled_prepare(struct Test* test);
+int database_select_run(struct Test* test);
+int database_range_run(struct Test* test);
+int database_delete_run(struct Test* test);
+int database_teardown(struct Test* test);
+#endif
+
+#endif //WATZBENCH_DATABASE_H
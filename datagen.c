@@ -0,0 +1,87 @@
+/*
+datagen.c fills the buffers tests write with data of a chosen kind.
+
+constant data hides anything that depends on the content: compression,
+deduplication, or flash where programming a bit from 1 to 0 costs more
+than leaving it. DATA_KIND picks what the buffers hold:
+ - DATA_CONSTANT: 'a's, what every test wrote before
+ - DATA_RANDOM: bytes that don't compress at all
+ - DATA_SENSOR: 16 bit little endian samples of a 12 bit adc reading that
+   follows a slow random walk, with a little noise on every sample
+ - DATA_TEXT: lines like "000042 node 3 temp 21.4 ok\n", a counter, a few
+   fixed words and changing numbers, cut off where the buffer ends
+
+buffers are filled in the prepare functions, so nothing is generated while
+a test is timed. a test writes the same buffer over and over, so the data
+repeats every buffer length. datagen_fill always restarts its generator
+from DATA_SEED, so every backend is given the same bytes.
+*/
+#include "datagen.h"
+
+static THREAD_LOCAL uint32_t state;
+
+// the same generator as pattern.c, kept apart so the two don't shift each other
+static unsigned int next(){
+    state = state * 1664525UL + 1013904223UL;
+    return (uint16_t)(state >> 16);
+}
+
+static void fill_sensor(char* buf, int bytes){
+    int value = DATAGEN_SENSOR_START;
+    int slope = 0;
+    for(int i = 0; i + 1 < bytes; i += 2){
+        if(next() % 16 == 0){
+            slope = (int)(next() % (2 * DATAGEN_SENSOR_DRIFT + 1)) - DATAGEN_SENSOR_DRIFT;
+        }
+        value += slope;
+        if(value < 0 || value > 4095){
+            slope = -slope;
+            value = (value < 0) ? 0 : 4095;
+        }
+        int sample = value + (int)(next() % (2 * DATAGEN_SENSOR_NOISE + 1)) - DATAGEN_SENSOR_NOISE;
+        sample = (sample < 0) ? 0 : (sample > 4095) ? 4095 : sample;
+        buf[i] = sample & 0xFF;
+        buf[i + 1] = sample >> 8;
+    }
+    if(bytes % 2 != 0){
+        buf[bytes - 1] = 0;
+    }
+}
+
+static void fill_text(char* buf, int bytes){
+    static const char* states[] = {"ok", "ok", "ok", "low", "retry"};
+    char line[40];
+    int at = 0;
+    int temp = 214;
+    for(unsigned int n = 0; at < bytes; n++){
+        temp += (int)(next() % 5) - 2;
+        int len = snprintf(line, sizeof(line), "%06u node %u temp %d.%d %s\n",
+            n, next() % 8, temp / 10, (temp < 0 ? -temp : temp) % 10, states[next() % 5]);
+        for(int i = 0; i < len && at < bytes; i++){
+            buf[at++] = line[i];
+        }
+    }
+}
+
+/*
+datagen_fill fills bytes of buf with DATA_KIND data
+*/
+void datagen_fill(char* buf, int bytes){
+    state = DATA_SEED;
+    switch(DATA_KIND){
+        case DATA_RANDOM:
+            for(int i = 0; i < bytes; i++){
+                buf[i] = next() & 0xFF;
+            }
+            break;
+        case DATA_SENSOR:
+            fill_sensor(buf, bytes);
+            break;
+        case DATA_TEXT:
+            fill_text(buf, bytes);
+            break;
+        default:
+            memset(buf, 'a', bytes);
+            break;
+    }
+}
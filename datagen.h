@@ -0,0 +1,28 @@
+/*
+datagen.c fills the buffers tests write with data of a chosen kind.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_DATAGEN_H
+#define WATZBENCH_DATAGEN_H
+#include <string.h>
+#include <stdint.h>
+#include "common.h"
+
+#define DATA_CONSTANT 0 // every byte is 'a'
+#define DATA_RANDOM 1   // uniformly random bytes
+#define DATA_SENSOR 2   // 16 bit samples of a slowly varying, noisy reading
+#define DATA_TEXT 3     // lines of a text log
+
+// Sensor: samples start here and drift by at most this much per sample, plus noise
+#define DATAGEN_SENSOR_START 2048
+#define DATAGEN_SENSOR_DRIFT 4
+#define DATAGEN_SENSOR_NOISE 3
+
+extern int DATA_KIND;
+extern int DATA_SEED;
+
+void datagen_fill(char* buf, int bytes);
+
+#endif //WATZBENCH_DATAGEN_H
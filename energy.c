@@ -0,0 +1,146 @@
+/*
+energy.c does the energy accounting for tests.
+
+contiki's energest keeps the time each component (cpu, low power mode,
+radio, flash) has been on. the flash read and write times come from the
+xmem driver, which switches ENERGEST_TYPE_FLASH_READ and _WRITE on around
+every read and page program, so they only cover the time the flash chip
+is busy. the software around it, and calls that only change metadata,
+are cpu time.
+
+the backends wrap every api call in energy_storage_begin and
+energy_storage_end, which count the calls and the bytes they moved and
+keep the time spent in them in storage_ticks. that time is for latency
+and is not turned into energy, the cpu and flash components already
+cover it. calls can nest (a vectored write made of write_at calls is one
+call), only the outermost one is counted.
+
+energy_start and energy_stop take energest snapshots around a test, and
+the times are converted with the ENERGY_*_UA currents and
+ENERGY_VOLTAGE_MV. everything is integer math, charge is worked out per
+whole second first so nothing overflows on the msp430.
+*/
+#include "energy.h"
+
+static const unsigned char types[ENERGY_COMPONENTS] = {
+    ENERGEST_TYPE_CPU,
+    ENERGEST_TYPE_LPM,
+    ENERGEST_TYPE_TRANSMIT,
+    ENERGEST_TYPE_LISTEN,
+    ENERGEST_TYPE_FLASH_READ,
+    ENERGEST_TYPE_FLASH_WRITE
+};
+
+static const unsigned long currents[ENERGY_COMPONENTS] = {
+    ENERGY_CPU_UA,
+    ENERGY_LPM_UA,
+    ENERGY_TX_UA,
+    ENERGY_RX_UA,
+    ENERGY_FLASH_READ_UA,
+    ENERGY_FLASH_WRITE_UA
+};
+
+static const char* names[ENERGY_COMPONENTS] = {"cpu", "lpm", "tx", "rx", "read", "write"};
+
+static THREAD_LOCAL unsigned long start[ENERGY_COMPONENTS];
+static THREAD_LOCAL unsigned char depth;
+static THREAD_LOCAL rtimer_clock_t call_start;
+static THREAD_LOCAL unsigned long storage_ticks;
+static THREAD_LOCAL unsigned long ops;
+static THREAD_LOCAL unsigned long written;
+static THREAD_LOCAL unsigned long read;
+
+void energy_storage_begin(){
+    if(depth++ == 0){
+        call_start = RTIMER_NOW();
+    }
+}
+
+void energy_storage_end(int written_bytes, int read_bytes){
+    if(written_bytes > 0){
+        written += written_bytes;
+    }
+    if(read_bytes > 0){
+        read += read_bytes;
+    }
+    if(--depth == 0){
+        storage_ticks += (rtimer_clock_t)(RTIMER_NOW() - call_start);
+        ops++;
+    }
+}
+
+void energy_start(){
+    energest_flush();
+    for(int i = 0; i < ENERGY_COMPONENTS; i++){
+        start[i] = energest_type_time(types[i]);
+    }
+    storage_ticks = 0;
+    ops = 0;
+    written = 0;
+    read = 0;
+}
+
+// microjoules used by a component drawing ua for ticks rtimer ticks
+static unsigned long microjoules(unsigned long ticks, unsigned long ua){
+    unsigned long uc = (ticks / RTIMER_SECOND) * ua
+        + ((ticks % RTIMER_SECOND) * ua) / RTIMER_SECOND;
+    return (uc / 1000) * ENERGY_VOLTAGE_MV + ((uc % 1000) * ENERGY_VOLTAGE_MV) / 1000;
+}
+
+void energy_stop(struct Energy* energy){
+    energest_flush();
+    energy->total_uj = 0;
+    for(int i = 0; i < ENERGY_COMPONENTS; i++){
+        energy->ticks[i] = energest_type_time(types[i]) - start[i];
+        energy->uj[i] = microjoules(energy->ticks[i], currents[i]);
+        energy->total_uj += energy->uj[i];
+    }
+    energy->storage_ticks = storage_ticks;
+    energy->ops = ops;
+    energy->written = written;
+    energy->read = read;
+}
+
+/*
+print_nj_per prints the nanojoules per unit with three decimals, a byte
+often takes less than one. the digits are worked out one at a time by long
+division so nothing overflows on the msp430.
+*/
+static void print_nj_per(unsigned long uj, unsigned long n){
+    unsigned long rem = uj % n;
+    unsigned long digits = 0; // the first six decimals of a microjoule
+    for(int i = 0; i < 6; i++){
+        rem *= 10;
+        digits = digits * 10 + rem / n;
+        rem %= n;
+    }
+    printf("%lu.%03lu nJ", (uj / n) * 1000 + digits / 1000, digits % 1000);
+}
+
+/*
+energy_print prints the energy of every component in microjoules, the
+total in millijoules and the total per api call and per byte
+*/
+void energy_print(struct Energy* energy){
+    printf("energy:");
+    for(int i = 0; i < ENERGY_COMPONENTS; i++){
+        printf(" %s %lu", names[i], energy->uj[i]);
+    }
+    printf(" uJ, total %lu.%03lu mJ\n", energy->total_uj / 1000, energy->total_uj % 1000);
+    if(energy->ops > 0){
+        printf("energy: %lu ops, ", energy->ops);
+        print_nj_per(energy->total_uj, energy->ops);
+        printf("/op");
+        if(energy->written > 0){
+            printf(", ");
+            print_nj_per(energy->total_uj, energy->written);
+            printf("/byte written");
+        }
+        if(energy->read > 0){
+            printf(", ");
+            print_nj_per(energy->total_uj, energy->read);
+            printf("/byte read");
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,95 @@
+/*
+energy.c turns energest times into energy for the tests, including the
+time the xmem driver keeps the flash busy.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_ENERGY_H
+#define WATZBENCH_ENERGY_H
+#include <stdio.h>
+#include "contiki.h"
+#include "sys/energest.h"
+#include "common.h"
+
+/*
+current draw of each component in microamps and the supply in millivolts.
+the defaults are the tmote sky datasheet figures at 3V, with the flash
+figures being the m25p80 read and page program currents. they can be
+overridden in project-conf.h.
+*/
+#ifdef ENERGY_CONF_VOLTAGE_MV
+#define ENERGY_VOLTAGE_MV ENERGY_CONF_VOLTAGE_MV
+#else
+#define ENERGY_VOLTAGE_MV 3000UL
+#endif
+
+#ifdef ENERGY_CONF_CPU_UA
+#define ENERGY_CPU_UA ENERGY_CONF_CPU_UA
+#else
+#define ENERGY_CPU_UA 1800UL
+#endif
+
+#ifdef ENERGY_CONF_LPM_UA
+#define ENERGY_LPM_UA ENERGY_CONF_LPM_UA
+#else
+#define ENERGY_LPM_UA 55UL
+#endif
+
+#ifdef ENERGY_CONF_TX_UA
+#define ENERGY_TX_UA ENERGY_CONF_TX_UA
+#else
+#define ENERGY_TX_UA 17700UL
+#endif
+
+#ifdef ENERGY_CONF_RX_UA
+#define ENERGY_RX_UA ENERGY_CONF_RX_UA
+#else
+#define ENERGY_RX_UA 20000UL
+#endif
+
+#ifdef ENERGY_CONF_FLASH_READ_UA
+#define ENERGY_FLASH_READ_UA ENERGY_CONF_FLASH_READ_UA
+#else
+#define ENERGY_FLASH_READ_UA 4000UL
+#endif
+
+#ifdef ENERGY_CONF_FLASH_WRITE_UA
+#define ENERGY_FLASH_WRITE_UA ENERGY_CONF_FLASH_WRITE_UA
+#else
+#define ENERGY_FLASH_WRITE_UA 15000UL
+#endif
+
+// Components, in the order they are reported
+#define ENERGY_CPU 0
+#define ENERGY_LPM 1
+#define ENERGY_TX 2
+#define ENERGY_RX 3
+#define ENERGY_FLASH_READ 4
+#define ENERGY_FLASH_WRITE 5
+#define ENERGY_COMPONENTS 6
+
+/*
+Energy is what one test used between energy_start and energy_stop. uj is
+in microjoules, ops and bytes count the api calls wrapped in
+energy_storage_begin/end and storage_ticks is the rtimer time spent in
+them.
+*/
+struct Energy{
+    unsigned long ticks[ENERGY_COMPONENTS];
+    unsigned long uj[ENERGY_COMPONENTS];
+    unsigned long total_uj;
+    unsigned long storage_ticks;
+    unsigned long ops;
+    unsigned long written;
+    unsigned long read;
+};
+
+void energy_storage_begin();
+void energy_storage_end(int written, int read);
+
+void energy_start();
+void energy_stop(struct Energy*);
+void energy_print(struct Energy*);
+
+#endif //WATZBENCH_ENERGY_H
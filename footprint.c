@@ -0,0 +1,45 @@
+/*
+footprint.c measures peak stack use by stack painting.
+
+footprint_paint fills FOOTPRINT_STACK_DEPTH bytes of the free stack below
+its caller with FOOTPRINT_PAINT. anything the caller runs afterwards
+(including interrupts, which share the stack on the sky) overwrites the
+paint from the top down. footprint_stack_peak, called from the same
+function, finds the deepest byte that no longer holds the paint.
+
+contiki processes are protothreads running on the one system stack, so
+this covers the benchmark process, the test and the backend underneath
+it. the stack is assumed to grow down, as it does on the msp430 and on
+native. a peak equal to FOOTPRINT_STACK_DEPTH means the painted area
+was used up and the real peak is at least that.
+*/
+#include <stdint.h>
+#include "footprint.h"
+
+// Lowest painted address, kept as an integer since it outlives the frame it points into
+static uintptr_t painted;
+
+/*
+the painted array is this function's own frame, which is free stack
+again once it returns. noinline keeps it at the caller's depth.
+*/
+__attribute__((noinline)) void footprint_paint(){
+    volatile unsigned char region[FOOTPRINT_STACK_DEPTH];
+    for(int i = 0; i < FOOTPRINT_STACK_DEPTH; i++){
+        region[i] = FOOTPRINT_PAINT;
+    }
+    painted = (uintptr_t)region;
+}
+
+/*
+footprint_stack_peak returns the bytes of stack used below the caller
+since footprint_paint
+*/
+__attribute__((noinline)) int footprint_stack_peak(){
+    volatile unsigned char* paint = (volatile unsigned char*)painted;
+    int untouched = 0;
+    while(untouched < FOOTPRINT_STACK_DEPTH && paint[untouched] == FOOTPRINT_PAINT){
+        untouched++;
+    }
+    return FOOTPRINT_STACK_DEPTH - untouched;
+}
@@ -0,0 +1,25 @@
+/*
+footprint.c measures how much stack the benchmark uses while a test runs.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_FOOTPRINT_H
+#define WATZBENCH_FOOTPRINT_H
+#include "contiki.h"
+
+#include "common.h"
+
+// Bytes of stack painted below the caller, it can be overridden in project-conf.h
+#ifdef FOOTPRINT_CONF_STACK_DEPTH
+#define FOOTPRINT_STACK_DEPTH FOOTPRINT_CONF_STACK_DEPTH
+#else
+#define FOOTPRINT_STACK_DEPTH 1024
+#endif
+
+#define FOOTPRINT_PAINT 0xA5
+
+void footprint_paint();
+int footprint_stack_peak();
+
+#endif //WATZBENCH_FOOTPRINT_H
@@ -0,0 +1,78 @@
+/*
+histogram.c collects latency distributions for tests that time individual
+operations.
+
+latencies are measured in rtimer ticks (RTIMER_SECOND per second), which is
+much finer than clock_time. buckets are powers of two, so adding a sample
+is cheap enough to do inside a timed loop and percentiles are reported as
+the upper bound of the bucket they fall in.
+*/
+#include "histogram.h"
+
+void histogram_reset(struct Histogram* hist){
+    hist->count = 0;
+    hist->total = 0;
+    hist->min = (unsigned int)-1;
+    hist->max = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++){
+        hist->buckets[i] = 0;
+    }
+}
+
+void histogram_add(struct Histogram* hist, unsigned int ticks){
+    int bucket = 0;
+    unsigned int t = ticks;
+    while(t != 0 && bucket < HISTOGRAM_BUCKETS - 1){
+        t >>= 1;
+        bucket++;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->total += ticks;
+    if(ticks < hist->min){
+        hist->min = ticks;
+    }
+    if(ticks > hist->max){
+        hist->max = ticks;
+    }
+}
+
+/*
+histogram_percentile returns the upper bound of the bucket the given
+percentile falls in
+*/
+unsigned int histogram_percentile(struct Histogram* hist, int percent){
+    unsigned long wanted = (hist->count * percent + 99) / 100;
+    unsigned long seen = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++){
+        seen += hist->buckets[i];
+        if(seen >= wanted && seen > 0){
+            unsigned int bound = (i == 0) ? 0 : (unsigned int)((1UL << i) - 1);
+            return (bound > hist->max) ? hist->max : bound;
+        }
+    }
+    return hist->max;
+}
+
+void histogram_print(struct Histogram* hist, char* label){
+    if(hist->count == 0){
+        printf("%s: no samples\n", label);
+        return;
+    }
+    printf("%s: %lu ops, min %u, avg %lu, p50 %u, p90 %u, p99 %u, max %u ticks\n",
+        label,
+        hist->count,
+        hist->min,
+        hist->total / hist->count,
+        histogram_percentile(hist, 50),
+        histogram_percentile(hist, 90),
+        histogram_percentile(hist, 99),
+        hist->max);
+    printf("%s:", label);
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++){
+        if(hist->buckets[i] != 0){
+            printf(" <%lu:%u", 1UL << i, hist->buckets[i]);
+        }
+    }
+    printf("\n");
+}
@@ -0,0 +1,33 @@
+/*
+histogram.c collects latency distributions for tests that time individual
+operations.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_HISTOGRAM_H
+#define WATZBENCH_HISTOGRAM_H
+#include <stdio.h>
+#include "contiki.h"
+#include "sys/rtimer.h"
+
+// Bucket 0 holds 0 ticks, bucket k holds [2^(k-1), 2^k) ticks
+#define HISTOGRAM_BUCKETS 17
+
+/*
+Histogram holds latencies in rtimer ticks
+*/
+struct Histogram{
+    unsigned long count;
+    unsigned long total;
+    unsigned int min;
+    unsigned int max;
+    unsigned int buckets[HISTOGRAM_BUCKETS];
+};
+
+void histogram_reset(struct Histogram*);
+void histogram_add(struct Histogram*, unsigned int ticks);
+unsigned int histogram_percentile(struct Histogram*, int percent);
+void histogram_print(struct Histogram*, char* label);
+
+#endif //WATZBENCH_HISTOGRAM_H
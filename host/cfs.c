@@ -0,0 +1,118 @@
+/*
+cfs.c is contiki's cfs for the host build, on top of posix files in the
+directory CFS_DIR.
+
+it keeps coffee's semantics rather than posix's where they differ:
+opening with CFS_APPEND puts the position at the end of the file but
+writes still go where the position is, and CFS_WRITE without CFS_APPEND
+truncates. both the CFS and Coffee backends use it.
+*/
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "cfs/cfs-coffee.h"
+
+#define CFS_DIR "watzbench.cfs"
+#define PATH_SIZE 64
+
+// path returns -1 when the name does not fit in PATH_SIZE
+static int path(char* buf, const char* name){
+    int n = snprintf(buf, PATH_SIZE, "%s/%s", CFS_DIR, name);
+    return (n < 0 || n >= PATH_SIZE) ? -1 : 0;
+}
+
+int cfs_open(const char* name, int flags){
+    char p[PATH_SIZE];
+    int mode = O_RDONLY;
+    if(flags & (CFS_WRITE | CFS_APPEND)){
+        mode = O_RDWR | O_CREAT;
+        if(!(flags & CFS_APPEND)){
+            mode |= O_TRUNC;
+        }
+    }
+    if(path(p, name) == -1){
+        return -1;
+    }
+    mkdir(CFS_DIR, 0755);
+    int fd = open(p, mode, 0644);
+    if(fd != -1 && (flags & CFS_APPEND)){
+        lseek(fd, 0, SEEK_END);
+    }
+    return fd;
+}
+
+void cfs_close(int fd){
+    close(fd);
+}
+
+int cfs_read(int fd, void* buf, unsigned int len){
+    return read(fd, buf, len);
+}
+
+int cfs_write(int fd, const void* buf, unsigned int len){
+    return write(fd, buf, len);
+}
+
+cfs_offset_t cfs_seek(int fd, cfs_offset_t offset, int whence){
+    int w = (whence == CFS_SEEK_CUR) ? SEEK_CUR : (whence == CFS_SEEK_END) ? SEEK_END : SEEK_SET;
+    return lseek(fd, offset, w);
+}
+
+int cfs_remove(const char* name){
+    char p[PATH_SIZE];
+    if(path(p, name) == -1){
+        return -1;
+    }
+    return (unlink(p) == 0 || rmdir(p) == 0) ? 0 : -1;
+}
+
+int cfs_opendir(struct cfs_dir* dirp, const char* name){
+    char p[PATH_SIZE];
+    if(dirp == NULL || path(p, name) == -1){
+        return -1;
+    }
+    dirp->dir = opendir(p);
+    return (dirp->dir == NULL) ? -1 : 0;
+}
+
+int cfs_readdir(struct cfs_dir* dirp, struct cfs_dirent* dirent){
+    struct dirent* e;
+    do{
+        e = readdir((DIR*)dirp->dir);
+    }while(e != NULL && e->d_name[0] == '.');
+    if(e == NULL){
+        return -1;
+    }
+    strncpy(dirent->name, e->d_name, sizeof(dirent->name) - 1);
+    dirent->name[sizeof(dirent->name) - 1] = '\0';
+    dirent->size = 0;
+    return 0;
+}
+
+void cfs_closedir(struct cfs_dir* dirp){
+    if(dirp->dir != NULL){
+        closedir((DIR*)dirp->dir);
+        dirp->dir = NULL;
+    }
+}
+
+// formatting removes every file in CFS_DIR
+int cfs_coffee_format(void){
+    char p[PATH_SIZE];
+    DIR* dir = opendir(CFS_DIR);
+    if(dir == NULL){
+        return 0;
+    }
+    struct dirent* e;
+    while((e = readdir(dir)) != NULL){
+        if(e->d_name[0] != '.' && path(p, e->d_name) == 0){
+            unlink(p);
+        }
+    }
+    closedir(dir);
+    return 0;
+}
@@ -0,0 +1,11 @@
+/*
+cfs-coffee.h for the host build, coffee is the same directory as cfs
+*/
+
+#ifndef WATZBENCH_HOST_CFS_COFFEE_H
+#define WATZBENCH_HOST_CFS_COFFEE_H
+#include "cfs/cfs.h"
+
+int cfs_coffee_format(void);
+
+#endif //WATZBENCH_HOST_CFS_COFFEE_H
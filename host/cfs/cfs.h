@@ -0,0 +1,37 @@
+/*
+cfs.h for the host build, cfs files are files in a directory (see cfs.c)
+*/
+
+#ifndef WATZBENCH_HOST_CFS_H
+#define WATZBENCH_HOST_CFS_H
+
+typedef long cfs_offset_t;
+
+struct cfs_dir{
+    void* dir;
+};
+
+struct cfs_dirent{
+    char name[32];
+    cfs_offset_t size;
+};
+
+#define CFS_READ 1
+#define CFS_WRITE 2
+#define CFS_APPEND 4
+
+#define CFS_SEEK_SET 0
+#define CFS_SEEK_CUR 1
+#define CFS_SEEK_END 2
+
+int cfs_open(const char* name, int flags);
+void cfs_close(int fd);
+int cfs_read(int fd, void* buf, unsigned int len);
+int cfs_write(int fd, const void* buf, unsigned int len);
+cfs_offset_t cfs_seek(int fd, cfs_offset_t offset, int whence);
+int cfs_remove(const char* name);
+int cfs_opendir(struct cfs_dir* dirp, const char* name);
+int cfs_readdir(struct cfs_dir* dirp, struct cfs_dirent* dirent);
+void cfs_closedir(struct cfs_dir* dirp);
+
+#endif //WATZBENCH_HOST_CFS_H
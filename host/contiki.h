@@ -0,0 +1,104 @@
+/*
+contiki.h for the host build. it provides the small part of contiki that
+watzbench uses: processes on protothreads, events, etimers and the clock.
+the macros follow contiki's, so the same sources build for both.
+
+additional information and descriptions are in host.c
+*/
+
+#ifndef WATZBENCH_HOST_CONTIKI_H
+#define WATZBENCH_HOST_CONTIKI_H
+#include <stddef.h>
+
+#ifdef PROJECT_CONF_H
+#include PROJECT_CONF_H
+#endif
+
+typedef unsigned int uint;
+
+// Clock, clock_time counts milliseconds since the program started
+typedef unsigned long clock_time_t;
+#define CLOCK_SECOND 1000UL
+clock_time_t clock_time(void);
+
+// Protothreads
+struct pt{
+    unsigned short lc;
+};
+
+#define PT_WAITING 0
+#define PT_YIELDED 1
+#define PT_EXITED 2
+#define PT_ENDED 3
+
+// Processes
+typedef unsigned char process_event_t;
+typedef void* process_data_t;
+
+struct process{
+    struct process* next;
+    const char* name;
+    char (*thread)(struct pt*, process_event_t, process_data_t);
+    struct pt pt;
+    unsigned char running;
+    unsigned char needspoll;
+};
+
+#define PROCESS_EVENT_NONE 0x80
+#define PROCESS_EVENT_INIT 0x81
+#define PROCESS_EVENT_POLL 0x82
+#define PROCESS_EVENT_EXIT 0x83
+#define PROCESS_EVENT_CONTINUE 0x85
+#define PROCESS_EVENT_EXITED 0x87
+#define PROCESS_EVENT_TIMER 0x88
+#define PROCESS_EVENT_MAX 0x8a
+
+#define PROCESS_BROADCAST NULL
+
+#define PROCESS_NAME(name) extern struct process name
+#define PROCESS_THREAD(name, ev, data) \
+    static char process_thread_##name(struct pt* process_pt, process_event_t ev, process_data_t data)
+#define PROCESS(name, strname) \
+    PROCESS_THREAD(name, ev, data); \
+    struct process name = {NULL, strname, process_thread_##name}
+#define AUTOSTART_PROCESSES(...) \
+    struct process* const autostart_processes[] = {__VA_ARGS__, NULL}
+
+#define PROCESS_BEGIN() { char pt_yield_flag = 1; (void)pt_yield_flag; switch(process_pt->lc){ case 0:
+#define PROCESS_END() } pt_yield_flag = 0; process_pt->lc = 0; return PT_ENDED; }
+#define PROCESS_YIELD() \
+    do{ pt_yield_flag = 0; process_pt->lc = __LINE__; case __LINE__: \
+        if(pt_yield_flag == 0){ return PT_YIELDED; } }while(0)
+#define PROCESS_YIELD_UNTIL(c) \
+    do{ pt_yield_flag = 0; process_pt->lc = __LINE__; case __LINE__: \
+        if(pt_yield_flag == 0 || !(c)){ return PT_YIELDED; } }while(0)
+#define PROCESS_WAIT_EVENT() PROCESS_YIELD()
+#define PROCESS_WAIT_EVENT_UNTIL(c) PROCESS_YIELD_UNTIL(c)
+#define PROCESS_EXIT() do{ process_pt->lc = 0; return PT_EXITED; }while(0)
+#define PROCESS_PAUSE() \
+    do{ process_post(PROCESS_CURRENT(), PROCESS_EVENT_CONTINUE, NULL); \
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_CONTINUE); }while(0)
+#define PROCESS_CURRENT() process_current
+
+extern struct process* process_current;
+
+process_event_t process_alloc_event(void);
+void process_start(struct process*, process_data_t);
+void process_exit(struct process*);
+int process_post(struct process*, process_event_t, process_data_t);
+void process_poll(struct process*);
+int process_is_running(struct process*);
+
+// Event timers
+struct etimer{
+    struct etimer* next;
+    struct process* p;
+    clock_time_t expires;
+    unsigned char active;
+};
+
+void etimer_set(struct etimer*, clock_time_t);
+void etimer_stop(struct etimer*);
+int etimer_expired(struct etimer*);
+
+#endif //WATZBENCH_HOST_CONTIKI_H
@@ -0,0 +1,11 @@
+/*
+serial-line.h for the host build, lines are read from stdin
+*/
+
+#ifndef WATZBENCH_HOST_SERIAL_LINE_H
+#define WATZBENCH_HOST_SERIAL_LINE_H
+#include "contiki.h"
+
+extern process_event_t serial_line_event_message;
+
+#endif //WATZBENCH_HOST_SERIAL_LINE_H
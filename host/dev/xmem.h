@@ -0,0 +1,19 @@
+/*
+xmem.h for the host build. the external flash is an image file that
+behaves like the sky's m25p80: programming only clears bits and erasing
+sets a whole unit back to 0xff.
+*/
+
+#ifndef WATZBENCH_HOST_XMEM_H
+#define WATZBENCH_HOST_XMEM_H
+#include <sys/types.h>
+
+#define XMEM_ERASE_UNIT_SIZE (64 * 1024L)
+#define XMEM_SIZE (16 * XMEM_ERASE_UNIT_SIZE)
+
+void xmem_init(void);
+int xmem_pread(void* buf, int nbytes, off_t offset);
+int xmem_pwrite(const void* buf, int nbytes, off_t offset);
+int xmem_erase(long nbytes, off_t offset);
+
+#endif //WATZBENCH_HOST_XMEM_H
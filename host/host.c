@@ -0,0 +1,360 @@
+/*
+host.c runs watzbench on linux without contiki.
+
+it is a small process scheduler in the style of contiki's: processes are
+protothreads, events are queued and delivered one at a time, polls are
+delivered before events, and a process that ends is announced to all
+others with PROCESS_EVENT_EXITED. etimers post PROCESS_EVENT_TIMER to the
+process that set them.
+
+main starts the autostart processes and then delivers events. when there
+is nothing to deliver it waits for the next etimer or a line on stdin,
+which is posted as serial_line_event_message like contiki's serial line
+does. the program ends at the end of stdin once nothing is pending.
+
+the files cfs and xmem use are kept in the directory given as the first
+argument, or the current directory.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "sys/energest.h"
+#include "lib/random.h"
+#include "dev/serial-line.h"
+#include "dev/xmem.h"
+
+#define EVENT_QUEUE_SIZE 32
+#define LINE_SIZE 128
+
+struct event{
+    process_event_t ev;
+    process_data_t data;
+    struct process* p;
+};
+
+struct process* process_current;
+static struct process* processes;
+static struct event events[EVENT_QUEUE_SIZE];
+static int first_event;
+static int event_count;
+static process_event_t last_event = PROCESS_EVENT_MAX;
+static int poll_requested;
+static struct etimer* timers;
+
+extern struct process* const autostart_processes[];
+process_event_t serial_line_event_message;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Clock Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static struct timespec boot;
+
+static unsigned long long since_boot_us(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)(now.tv_sec - boot.tv_sec) * 1000000ULL
+        + (now.tv_nsec - boot.tv_nsec) / 1000;
+}
+
+clock_time_t clock_time(void){
+    return (clock_time_t)(since_boot_us() / 1000);
+}
+
+rtimer_clock_t rtimer_arch_now(void){
+    return (rtimer_clock_t)since_boot_us();
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Energest Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+__thread unsigned long energest_total_time[ENERGEST_TYPE_MAX];
+__thread rtimer_clock_t energest_current_time[ENERGEST_TYPE_MAX];
+__thread unsigned char energest_current_mode[ENERGEST_TYPE_MAX];
+
+unsigned long energest_type_time(int type){
+    return energest_total_time[type];
+}
+
+// energest_flush adds the time of components that are on to their totals
+void energest_flush(void){
+    rtimer_clock_t now = RTIMER_NOW();
+    for(int i = 0; i < ENERGEST_TYPE_MAX; i++){
+        if(energest_current_mode[i] != 0){
+            energest_total_time[i] += now - energest_current_time[i];
+            energest_current_time[i] = now;
+        }
+    }
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Random Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+void random_init(unsigned short seed){
+    srand(seed);
+}
+
+unsigned short random_rand(void){
+    return (unsigned short)rand();
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Process Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void exit_process(struct process* p, struct process* fromprocess);
+
+process_event_t process_alloc_event(void){
+    return last_event++;
+}
+
+int process_is_running(struct process* p){
+    return p->running;
+}
+
+// call delivers one event to a process right away
+static void call(struct process* p, process_event_t ev, process_data_t data){
+    if(!p->running){
+        return;
+    }
+    struct process* caller = process_current;
+    process_current = p;
+    char ret = p->thread(&p->pt, ev, data);
+    if(ret == PT_EXITED || ret == PT_ENDED || ev == PROCESS_EVENT_EXIT){
+        exit_process(p, p);
+    }
+    process_current = caller;
+}
+
+/*
+exit_process takes a process out of the list and tells every other process
+it is gone. a process exited by someone else gets PROCESS_EVENT_EXIT first.
+*/
+static void exit_process(struct process* p, struct process* fromprocess){
+    if(!p->running){
+        return;
+    }
+    if(p != fromprocess){
+        process_current = p;
+        p->thread(&p->pt, PROCESS_EVENT_EXIT, NULL);
+    }
+    p->running = 0;
+    for(struct process** q = &processes; *q != NULL; q = &(*q)->next){
+        if(*q == p){
+            *q = p->next;
+            break;
+        }
+    }
+    for(struct process* q = processes; q != NULL; q = q->next){
+        call(q, PROCESS_EVENT_EXITED, p);
+    }
+}
+
+void process_start(struct process* p, process_data_t data){
+    if(p->running){
+        return;
+    }
+    p->next = processes;
+    processes = p;
+    p->running = 1;
+    p->needspoll = 0;
+    p->pt.lc = 0;
+    call(p, PROCESS_EVENT_INIT, data);
+}
+
+void process_exit(struct process* p){
+    struct process* caller = process_current;
+    exit_process(p, caller);
+    process_current = caller;
+}
+
+int process_post(struct process* p, process_event_t ev, process_data_t data){
+    if(event_count == EVENT_QUEUE_SIZE){
+        return 1;
+    }
+    struct event* e = &events[(first_event + event_count) % EVENT_QUEUE_SIZE];
+    e->ev = ev;
+    e->data = data;
+    e->p = p;
+    event_count++;
+    return 0;
+}
+
+void process_poll(struct process* p){
+    if(p != NULL && p->running){
+        p->needspoll = 1;
+        poll_requested = 1;
+    }
+}
+
+// run delivers pending polls and then one event, it returns 0 when idle
+static int run(){
+    // one round only, like contiki, a process polling itself can't starve the events
+    if(poll_requested){
+        poll_requested = 0;
+        for(struct process* p = processes; p != NULL; p = p->next){
+            if(p->needspoll){
+                p->needspoll = 0;
+                call(p, PROCESS_EVENT_POLL, NULL);
+            }
+        }
+    }
+    if(event_count == 0){
+        return 0;
+    }
+    struct event e = events[first_event];
+    first_event = (first_event + 1) % EVENT_QUEUE_SIZE;
+    event_count--;
+    if(e.p == PROCESS_BROADCAST){
+        for(struct process* p = processes; p != NULL; p = p->next){
+            call(p, e.ev, e.data);
+        }
+    }else{
+        call(e.p, e.ev, e.data);
+    }
+    return 1;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Etimer Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+void etimer_set(struct etimer* et, clock_time_t interval){
+    etimer_stop(et);
+    et->p = PROCESS_CURRENT();
+    et->expires = clock_time() + interval;
+    et->active = 1;
+    et->next = timers;
+    timers = et;
+}
+
+void etimer_stop(struct etimer* et){
+    for(struct etimer** t = &timers; *t != NULL; t = &(*t)->next){
+        if(*t == et){
+            *t = et->next;
+            break;
+        }
+    }
+    et->active = 0;
+}
+
+int etimer_expired(struct etimer* et){
+    return !et->active;
+}
+
+// expire_timers posts the timers that are due, it returns the ms to the next one or -1
+static long expire_timers(){
+    long next = -1;
+    clock_time_t now = clock_time();
+    struct etimer* t = timers;
+    while(t != NULL){
+        struct etimer* following = t->next;
+        if(t->expires <= now){
+            etimer_stop(t);
+            process_post(t->p, PROCESS_EVENT_TIMER, t);
+        }else if(next == -1 || (long)(t->expires - now) < next){
+            next = t->expires - now;
+        }
+        t = following;
+    }
+    return next;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Main
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+static char input[LINE_SIZE * 4]; // Bytes read from stdin that aren't a line yet
+static int input_bytes;
+static int input_open = 1;
+
+/*
+read_line moves the next complete line of input into line, it returns 0
+if there is none buffered
+*/
+static int read_line(char* line){
+    for(int i = 0; i < input_bytes; i++){
+        if(input[i] == '\n' || (!input_open && i == input_bytes - 1)){
+            int n = (input[i] == '\n') ? i : i + 1;
+            if(n > LINE_SIZE - 1){
+                n = LINE_SIZE - 1;
+            }
+            memcpy(line, input, n);
+            line[n] = '\0';
+            line[strcspn(line, "\r")] = '\0';
+            memmove(input, input + i + 1, input_bytes - i - 1);
+            input_bytes -= i + 1;
+            return 1;
+        }
+    }
+    if(input_bytes == sizeof(input)){
+        input_bytes = 0; // a line that doesn't fit is dropped
+    }
+    return 0;
+}
+
+/*
+wait blocks until stdin is readable or timeout_ms pass (-1 waits for
+stdin only), and reads what is there. the cpu is counted as in low power
+mode meanwhile.
+*/
+static void wait(long timeout_ms){
+    fd_set fds;
+    struct timeval tv;
+    FD_ZERO(&fds);
+    if(input_open){
+        FD_SET(STDIN_FILENO, &fds);
+    }
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    ENERGEST_OFF(ENERGEST_TYPE_CPU);
+    ENERGEST_ON(ENERGEST_TYPE_LPM);
+    int ready = select(STDIN_FILENO + 1, &fds, NULL, NULL, (timeout_ms < 0) ? NULL : &tv);
+    ENERGEST_OFF(ENERGEST_TYPE_LPM);
+    ENERGEST_ON(ENERGEST_TYPE_CPU);
+    if(ready > 0 && input_open){
+        ssize_t got = read(STDIN_FILENO, input + input_bytes, sizeof(input) - input_bytes);
+        if(got <= 0){
+            input_open = 0;
+        }else{
+            input_bytes += got;
+        }
+    }
+}
+
+int main(int argc, char** argv){
+    static char line[LINE_SIZE];
+    if(argc > 1 && chdir(argv[1]) != 0){
+        perror(argv[1]);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &boot);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    ENERGEST_ON(ENERGEST_TYPE_CPU);
+    random_init(1);
+    xmem_init();
+    serial_line_event_message = process_alloc_event();
+    for(int i = 0; autostart_processes[i] != NULL; i++){
+        process_start(autostart_processes[i], NULL);
+    }
+    while(processes != NULL){
+        while(run()){
+        }
+        long next = expire_timers();
+        if(event_count > 0 || poll_requested){
+            continue;
+        }
+        if(read_line(line)){
+            process_post(PROCESS_BROADCAST, serial_line_event_message, line);
+            continue;
+        }
+        if(!input_open && input_bytes == 0 && next == -1){
+            break;
+        }
+        wait(next);
+    }
+    return 0;
+}
@@ -0,0 +1,13 @@
+/*
+random.h for the host build
+*/
+
+#ifndef WATZBENCH_HOST_RANDOM_H
+#define WATZBENCH_HOST_RANDOM_H
+
+#define RANDOM_RAND_MAX 65535U
+
+void random_init(unsigned short seed);
+unsigned short random_rand(void);
+
+#endif //WATZBENCH_HOST_RANDOM_H
@@ -0,0 +1,42 @@
+/*
+energest.h for the host build. the cpu is on while the program runs and
+in low power mode while it waits for input or a timer, the radio is never
+on.
+*/
+
+#ifndef WATZBENCH_HOST_ENERGEST_H
+#define WATZBENCH_HOST_ENERGEST_H
+#include "contiki.h"
+#include "sys/rtimer.h"
+
+enum energest_type{
+    ENERGEST_TYPE_CPU,
+    ENERGEST_TYPE_LPM,
+    ENERGEST_TYPE_IRQ,
+    ENERGEST_TYPE_TRANSMIT,
+    ENERGEST_TYPE_LISTEN,
+    ENERGEST_TYPE_FLASH_READ,
+    ENERGEST_TYPE_FLASH_WRITE,
+    ENERGEST_TYPE_MAX
+};
+
+// every thread accounts its own time, see scale.c
+extern __thread unsigned long energest_total_time[ENERGEST_TYPE_MAX];
+extern __thread rtimer_clock_t energest_current_time[ENERGEST_TYPE_MAX];
+extern __thread unsigned char energest_current_mode[ENERGEST_TYPE_MAX];
+
+#define ENERGEST_ON(type) do{ \
+        energest_current_time[type] = RTIMER_NOW(); \
+        energest_current_mode[type] = 1; \
+    }while(0)
+#define ENERGEST_OFF(type) do{ \
+        if(energest_current_mode[type] != 0){ \
+            energest_total_time[type] += RTIMER_NOW() - energest_current_time[type]; \
+            energest_current_mode[type] = 0; \
+        } \
+    }while(0)
+
+unsigned long energest_type_time(int type);
+void energest_flush(void);
+
+#endif //WATZBENCH_HOST_ENERGEST_H
@@ -0,0 +1,14 @@
+/*
+rtimer.h for the host build, rtimer ticks are microseconds
+*/
+
+#ifndef WATZBENCH_HOST_RTIMER_H
+#define WATZBENCH_HOST_RTIMER_H
+
+typedef unsigned long rtimer_clock_t;
+#define RTIMER_SECOND 1000000UL
+#define RTIMER_NOW() rtimer_arch_now()
+
+rtimer_clock_t rtimer_arch_now(void);
+
+#endif //WATZBENCH_HOST_RTIMER_H
@@ -0,0 +1,76 @@
+/*
+xmem.c is the external flash for the host build, an XMEM_SIZE image file
+named XMEM_FILE. a new image starts out erased. like nor flash,
+programming ANDs the new bytes into what is there, so writing over data
+without erasing first reads back wrong, which is what logfs and the
+journal have to avoid on the sky too.
+
+like the sky driver, reads and writes switch the energest flash read and
+write types on while they run.
+*/
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "dev/xmem.h"
+#include "sys/energest.h"
+
+#define XMEM_FILE "watzbench.flash"
+#define XMEM_CHUNK 4096
+
+static int image = -1;
+
+void xmem_init(void){
+    struct stat st;
+    image = open(XMEM_FILE, O_RDWR | O_CREAT, 0644);
+    if(image == -1){
+        perror(XMEM_FILE);
+        return;
+    }
+    if(fstat(image, &st) == 0 && st.st_size < XMEM_SIZE){
+        xmem_erase(XMEM_SIZE, 0);
+    }
+}
+
+static void image_read(void* buf, int nbytes, off_t offset){
+    if(pread(image, buf, nbytes, offset) != nbytes){
+        memset(buf, 0xff, nbytes);
+    }
+}
+
+int xmem_pread(void* buf, int nbytes, off_t offset){
+    ENERGEST_ON(ENERGEST_TYPE_FLASH_READ);
+    image_read(buf, nbytes, offset);
+    ENERGEST_OFF(ENERGEST_TYPE_FLASH_READ);
+    return nbytes;
+}
+
+int xmem_pwrite(const void* buf, int nbytes, off_t offset){
+    unsigned char old[XMEM_CHUNK];
+    const unsigned char* p = buf;
+    int done = 0;
+    ENERGEST_ON(ENERGEST_TYPE_FLASH_WRITE);
+    while(done < nbytes){
+        int chunk = (nbytes - done < XMEM_CHUNK) ? nbytes - done : XMEM_CHUNK;
+        image_read(old, chunk, offset + done);
+        for(int i = 0; i < chunk; i++){
+            old[i] &= p[done + i];
+        }
+        pwrite(image, old, chunk, offset + done);
+        done += chunk;
+    }
+    ENERGEST_OFF(ENERGEST_TYPE_FLASH_WRITE);
+    return nbytes;
+}
+
+int xmem_erase(long nbytes, off_t offset){
+    unsigned char erased[XMEM_CHUNK];
+    memset(erased, 0xff, sizeof(erased));
+    offset -= offset % XMEM_ERASE_UNIT_SIZE;
+    for(long at = 0; at < nbytes; at += XMEM_CHUNK){
+        pwrite(image, erased, XMEM_CHUNK, offset + at);
+    }
+    return nbytes;
+}
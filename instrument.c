@@ -0,0 +1,165 @@
+/*
+instrument.c breaks the cost of a test down by api call.
+
+Instrumented is a decorator api. instrument_attach points it at a real
+backend, and every call made to Instrumented is timed with the rtimer and
+passed on to that backend. for each api entry it keeps the number of
+calls, their total, shortest and longest time and the bytes they moved
+(only what a call reports as done, a failed write moves nothing).
+
+run_test resets the counts before a test runs and prints them after, so
+they cover run() alone, prepare and teardown are timed as a whole by
+run_test. instrument_print prints one line per entry that was called.
+*/
+#include "instrument.h"
+
+struct API* Instrumented; // Pointer to the Instrumented API
+
+static struct OpCost costs[INSTRUMENT_OPS];
+static struct API* target;
+
+static const char* const names[INSTRUMENT_OPS] = {
+    "create_file", "delete_file", "create_dir", "delete_dir", "open_get_fd",
+    "write_at", "read_at", "close_fd", "append", "read_next", "flush",
+    "writev_at", "readv_at", "list_dir"
+};
+
+/*
+instrument_attach makes Instrumented pass its calls on to api
+*/
+void instrument_attach(struct API* api){
+    target = api;
+}
+
+void instrument_reset(){
+    for(int i = 0; i < INSTRUMENT_OPS; i++){
+        costs[i].count = 0;
+        costs[i].total = 0;
+        costs[i].min = (unsigned int)-1;
+        costs[i].max = 0;
+        costs[i].bytes = 0;
+    }
+}
+
+void instrument_print(){
+    for(int i = 0; i < INSTRUMENT_OPS; i++){
+        struct OpCost* c = &costs[i];
+        if(c->count == 0){
+            continue;
+        }
+        printf("cost: %s %lu calls, total %lu, min %u, avg %lu, max %u ticks, %lu bytes\n",
+            names[i], c->count, c->total, c->min, c->total / c->count, c->max, c->bytes);
+    }
+}
+
+int instrument_static_ram(){
+    return sizeof(costs);
+}
+
+// account adds a call that started at start, and hands back its result
+static int account(int op, rtimer_clock_t start, int bytes, int ret){
+    unsigned int ticks = (rtimer_clock_t)(RTIMER_NOW() - start);
+    struct OpCost* c = &costs[op];
+    c->count++;
+    c->total += ticks;
+    if(ticks < c->min){
+        c->min = ticks;
+    }
+    if(ticks > c->max){
+        c->max = ticks;
+    }
+    if(ret != -1 && bytes > 0){
+        c->bytes += bytes;
+    }
+    return ret;
+}
+
+static int vec_bytes(struct IOVec* vec, int count){
+    int bytes = 0;
+    for(int i = 0; i < count; i++){
+        bytes += vec[i].bytes;
+    }
+    return bytes;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Instrumented Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+void instrumented_init(){
+    target->init();
+}
+
+int instrumented_create_file(char* name){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_CREATE_FILE, start, 0, target->create_file(name));
+}
+
+int instrumented_delete_file(char* name){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_DELETE_FILE, start, 0, target->delete_file(name));
+}
+
+int instrumented_create_dir(char* name){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_CREATE_DIR, start, 0, target->create_dir(name));
+}
+
+int instrumented_delete_dir(char* name){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_DELETE_DIR, start, 0, target->delete_dir(name));
+}
+
+int instrumented_open_get_fd(char* name){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_OPEN, start, 0, target->open_get_fd(name));
+}
+
+int instrumented_write_at(int fd, int start_pos, int bytes, char* buf){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_WRITE_AT, start, bytes, target->write_at(fd, start_pos, bytes, buf));
+}
+
+// reads count the bytes they returned
+int instrumented_read_at(int fd, int start_pos, int bytes, char* buf){
+    rtimer_clock_t start = RTIMER_NOW();
+    int ret = target->read_at(fd, start_pos, bytes, buf);
+    return account(INSTRUMENT_READ_AT, start, ret, ret);
+}
+
+int instrumented_close_fd(int fd){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_CLOSE, start, 0, target->close_fd(fd));
+}
+
+int instrumented_append(int fd, int bytes, char* buf){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_APPEND, start, bytes, target->append(fd, bytes, buf));
+}
+
+int instrumented_read_next(int fd, int bytes, char* buf){
+    rtimer_clock_t start = RTIMER_NOW();
+    int ret = target->read_next(fd, bytes, buf);
+    return account(INSTRUMENT_READ_NEXT, start, ret, ret);
+}
+
+int instrumented_flush(int fd){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_FLUSH, start, 0, target->flush(fd));
+}
+
+int instrumented_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    rtimer_clock_t start = RTIMER_NOW();
+    int ret = target->writev_at(fd, start_pos, vec, count);
+    return account(INSTRUMENT_WRITEV_AT, start, vec_bytes(vec, count), ret);
+}
+
+int instrumented_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    rtimer_clock_t start = RTIMER_NOW();
+    int ret = target->readv_at(fd, start_pos, vec, count);
+    return account(INSTRUMENT_READV_AT, start, ret, ret);
+}
+
+int instrumented_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    rtimer_clock_t start = RTIMER_NOW();
+    return account(INSTRUMENT_LIST_DIR, start, 0, target->list_dir(name, visit, arg));
+}
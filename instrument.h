@@ -0,0 +1,65 @@
+/*
+instrument.c breaks the cost of a test down by api call.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_INSTRUMENT_H
+#define WATZBENCH_INSTRUMENT_H
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "api.h"
+#include "common.h"
+
+// The api entries that are counted, in the order of struct API
+#define INSTRUMENT_CREATE_FILE 0
+#define INSTRUMENT_DELETE_FILE 1
+#define INSTRUMENT_CREATE_DIR 2
+#define INSTRUMENT_DELETE_DIR 3
+#define INSTRUMENT_OPEN 4
+#define INSTRUMENT_WRITE_AT 5
+#define INSTRUMENT_READ_AT 6
+#define INSTRUMENT_CLOSE 7
+#define INSTRUMENT_APPEND 8
+#define INSTRUMENT_READ_NEXT 9
+#define INSTRUMENT_FLUSH 10
+#define INSTRUMENT_WRITEV_AT 11
+#define INSTRUMENT_READV_AT 12
+#define INSTRUMENT_LIST_DIR 13
+#define INSTRUMENT_OPS 14
+
+/*
+OpCost is what is known about one api entry, times are in rtimer ticks
+*/
+struct OpCost{
+    unsigned long count;
+    unsigned long total;
+    unsigned int min;
+    unsigned int max;
+    unsigned long bytes;
+};
+
+extern struct API* Instrumented;
+
+void instrument_attach(struct API*);
+void instrument_reset();
+void instrument_print();
+int instrument_static_ram();
+
+void instrumented_init();
+int instrumented_create_file(char*);
+int instrumented_delete_file(char*);
+int instrumented_create_dir(char*);
+int instrumented_delete_dir(char*);
+int instrumented_open_get_fd(char*);
+int instrumented_write_at(int, int, int, char*);
+int instrumented_read_at(int, int, int, char*);
+int instrumented_close_fd(int);
+int instrumented_append(int, int, char*);
+int instrumented_read_next(int, int, char*);
+int instrumented_flush(int);
+int instrumented_writev_at(int, int, struct IOVec*, int);
+int instrumented_readv_at(int, int, struct IOVec*, int);
+int instrumented_list_dir(char*, void (*)(char*, void*), void*);
+
+#endif //WATZBENCH_INSTRUMENT_H
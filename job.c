@@ -0,0 +1,223 @@
+/*
+job.c runs workloads that are described as tables instead of code.
+
+a job is a const array of JobPhase, which the compiler keeps in rom. a test
+created with new_job_test uses job_prepare, job_run and job_teardown, which
+carry out the phases of its job belonging to that stage, in order. all
+the state a job needs (fds, the data buffer and precomputed offsets) is
+allocated by job_prepare from what the phases ask for.
+
+files are named by number, like the hand-written tests do. with VERIFY
+set, writes carry a pattern derived from the file and offset and reads are
+checked against it (see verify.c). Null stores nothing, so it is not
+verified.
+*/
+#include "job.h"
+
+static int job_value(int value){
+    switch(value){
+        case JOB_WRITE_BYTES:
+            return WRITE_BYTES;
+        case JOB_BUFFER:
+            return BUFFER;
+        case JOB_FILES:
+            return FILES_TO_CREATE;
+    }
+    return value;
+}
+
+/*
+new_job_test is a constructor for a test that runs a job
+*/
+struct Test* new_job_test(char* test_name, const struct Job* job){
+    struct Test* test = new_test(test_name, job_prepare, job_run, job_teardown);
+    test->job = job;
+    return test;
+}
+
+/*
+job_phase carries out one phase. offset points at the next precomputed
+offset for JOB_RANDOM phases. it returns -1 as soon as a create or open
+fails, a write fails or a read comes back short. deletes and closes are
+not checked, teardown runs them after a failed prepare too.
+*/
+static int job_phase(struct Test* test, const struct JobPhase* phase, int** offset){
+    struct TestParams* params = test->params;
+    int first = job_value(phase->first);
+    int files = job_value(phase->files);
+    int count = job_value(phase->count);
+    int size = job_value(phase->size);
+    int chunk = job_value(phase->chunk);
+    int verify = VERIFY && test->api != Null;
+    int calls = 0;
+    for(int f = first; f < first + files; f++){
+        char* filename = FILE_NAME(params, f);
+        switch(phase->op){
+            case JOB_CREATE:
+                if(API_CALL(test->api, create_file)(filename) == -1){
+                    return -1;
+                }
+                continue;
+            case JOB_DELETE:
+                API_CALL(test->api, delete_file)(filename);
+                continue;
+            case JOB_OPEN:
+                params->fds[f] = API_CALL(test->api, open_get_fd)(filename);
+                if(params->fds[f] == -1){
+                    return -1;
+                }
+                continue;
+            case JOB_CLOSE:
+                if(params->fds[f] != -1){
+                    API_CALL(test->api, close_fd)(params->fds[f]);
+                    params->fds[f] = -1;
+                }
+                continue;
+        }
+        int tail = 0;
+        for(int rep = 0; rep < count; rep++){
+            if(phase->flags & JOB_REOPEN){
+                params->fds[f] = API_CALL(test->api, open_get_fd)(filename);
+                if(params->fds[f] == -1){
+                    return -1;
+                }
+            }
+            int fd = params->fds[f];
+            int at = 0;
+            while(at < size){
+                int bytes = (size - at < chunk) ? size - at : chunk;
+                int pos = at;
+                int next = (phase->pattern == JOB_NEXT) || (phase->pattern == JOB_STREAM && at != 0);
+                if(phase->pattern == JOB_TAIL || phase->pattern == JOB_NEXT){
+                    pos = tail + at; // where the stream is for JOB_NEXT, only used to verify
+                }else if(phase->pattern == JOB_RANDOM){
+                    pos = *(*offset)++;
+                }
+                if(phase->op == JOB_WRITE){
+                    if(verify){
+                        verify_fill(params->buffer, f, pos, bytes);
+                    }
+                    int err;
+                    if(next){
+                        err = API_CALL(test->api, append)(fd, bytes, params->buffer);
+                    }else{
+                        err = API_CALL(test->api, write_at)(fd, pos, bytes, params->buffer);
+                    }
+                    if(err == -1){
+                        return -1;
+                    }
+                }else{
+                    int got;
+                    if(next){
+                        got = API_CALL(test->api, read_next)(fd, bytes, params->buffer);
+                    }else{
+                        got = API_CALL(test->api, read_at)(fd, pos, bytes, params->buffer);
+                    }
+                    if(verify){
+                        verify_check(params->buffer, f, pos, bytes, got);
+                    }
+                    if(got != bytes){
+                        return -1;
+                    }
+                }
+                at += bytes;
+                calls++;
+                if((phase->flags & JOB_FLUSH) && FLUSH_INTERVAL > 0 && calls % FLUSH_INTERVAL == 0){
+                    if(API_CALL(test->api, flush)(fd) == -1){
+                        return -1;
+                    }
+                }
+            }
+            tail += size;
+            if(phase->flags & JOB_REOPEN){
+                API_CALL(test->api, close_fd)(fd);
+                params->fds[f] = -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int job_stage(struct Test* test, unsigned char stage){
+    int* offset = test->params->rands;
+    for(int i = 0; i < test->job->phase_count; i++){
+        const struct JobPhase* phase = &test->job->phases[i];
+        if(phase->stage == stage && job_phase(test, phase, &offset) == -1){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+job_prepare sizes and allocates the test parameters for the job, then
+carries out its prepare phases
+*/
+int job_prepare(struct Test* test){
+    test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
+    int fds = 0;
+    int buffer = 0;
+    int rands = 0;
+    for(int i = 0; i < test->job->phase_count; i++){
+        const struct JobPhase* phase = &test->job->phases[i];
+        int end = job_value(phase->first) + job_value(phase->files);
+        int chunk = job_value(phase->chunk);
+        if(end > fds){
+            fds = end;
+        }
+        if(chunk > buffer){
+            buffer = chunk;
+        }
+        if(phase->pattern == JOB_RANDOM && phase->stage == JOB_RUN){
+            int size = job_value(phase->size);
+            rands += job_value(phase->files) * job_value(phase->count) * ((size + chunk - 1) / chunk);
+        }
+    }
+    void* t = arena_alloc(sizeof(int) * fds);
+    test->params->fds = (int*)t;
+    name_files(test->params, fds);
+    if(buffer > 0){
+        t = arena_alloc(buffer);
+        test->params->buffer = (char*)t;
+    }
+    if(rands > 0){
+        t = arena_alloc(sizeof(int) * rands);
+        test->params->rands = (int*)t;
+    }
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
+    }
+    for(int i = 0; i < fds; i++){
+        test->params->fds[i] = -1;
+    }
+    if(buffer > 0){
+        datagen_fill(test->params->buffer, buffer);
+    }
+    if(rands > 0){
+        int* offset = test->params->rands;
+        for(int i = 0; i < test->job->phase_count; i++){
+            const struct JobPhase* phase = &test->job->phases[i];
+            if(phase->pattern == JOB_RANDOM && phase->stage == JOB_RUN){
+                int size = job_value(phase->size);
+                int chunk = job_value(phase->chunk);
+                int n = job_value(phase->files) * job_value(phase->count) * ((size + chunk - 1) / chunk);
+                pattern_fill(offset, n, size - chunk);
+                offset += n;
+            }
+        }
+    }
+    return job_stage(test, JOB_PREPARE);
+}
+
+int job_run(struct Test* test){
+    return job_stage(test, JOB_RUN);
+}
+
+int job_teardown(struct Test* test){
+    int err = job_stage(test, JOB_TEARDOWN);
+    test->params = NULL;
+    return err;
+}
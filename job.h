@@ -0,0 +1,73 @@
+/*
+job.c runs workloads that are described as tables instead of code. a job
+is a list of phases, and one interpreter carries out the phases of every
+job, so a new workload only costs a table in rom.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_JOB_H
+#define WATZBENCH_JOB_H
+#include "test.h"
+#include "verify.h"
+
+// Stages, which of prepare/run/teardown a phase belongs to
+#define JOB_PREPARE 0
+#define JOB_RUN 1
+#define JOB_TEARDOWN 2
+
+// Operations, done once for every file in the set
+#define JOB_CREATE 0
+#define JOB_DELETE 1
+#define JOB_OPEN 2
+#define JOB_CLOSE 3
+#define JOB_WRITE 4
+#define JOB_READ 5
+
+// Patterns, where the calls of a JOB_WRITE or JOB_READ go
+#define JOB_SEQ 0       // each repetition covers [0, size) with positioned calls
+#define JOB_TAIL 1      // like JOB_SEQ, but each repetition continues after the last
+#define JOB_STREAM 2    // the first call of a repetition is positioned at 0, the rest stream
+#define JOB_NEXT 3      // every call streams (append or read_next)
+#define JOB_RANDOM 4    // positioned calls at offsets from ACCESS_PATTERN
+
+// Flags
+#define JOB_REOPEN 0x01 // open before and close after each repetition
+#define JOB_FLUSH 0x02  // flush every FLUSH_INTERVAL calls
+
+// Values that are only known at runtime
+#define JOB_WRITE_BYTES -1
+#define JOB_BUFFER -2
+#define JOB_FILES -3
+
+/*
+JobPhase is one step of a job. the file set is the files named first to
+first + files - 1. for JOB_WRITE and JOB_READ, every file gets count
+repetitions of size bytes, moved in calls of chunk bytes.
+*/
+struct JobPhase{
+    unsigned char stage;
+    unsigned char op;
+    unsigned char pattern;
+    unsigned char flags;
+    int first;
+    int files;
+    int count;
+    int size;
+    int chunk;
+};
+
+struct Job{
+    const struct JobPhase* phases;
+    unsigned char phase_count;
+};
+
+#define JOB(phases) {phases, sizeof(phases) / sizeof(struct JobPhase)}
+
+struct Test* new_job_test(char*, const struct Job*);
+
+int job_prepare(struct Test* test);
+int job_run(struct Test* test);
+int job_teardown(struct Test* test);
+
+#endif //WATZBENCH_JOB_H
@@ -0,0 +1,144 @@
+/*
+journal.c is a compact binary journal of results, kept in a flash area
+outside the benchmarked filesystems.
+
+run_test appends one JournalRecord for every completed run. records are
+written in order into fixed size slots, so at boot init_journal finds the
+end of the journal by reading the magic of each slot until it hits an
+erased one, and carries on numbering from the last record. nothing about
+the journal is kept in ram apart from the next free slot.
+
+the console dumps the journal (one comma separated line per record) and
+clears it, keeping the node id in front of it.
+*/
+#include "journal.h"
+#include "test.h"
+#include "params.h"
+
+static unsigned int next_slot;
+static unsigned short next_seq;
+
+static unsigned long slot_addr(unsigned int slot){
+    return JOURNAL_START + (unsigned long)slot * sizeof(struct JournalRecord);
+}
+
+/*
+init_journal is called when the program starts, it finds the first free
+slot. a slot that is neither free nor a record holds a journal written by
+a build with another record layout, which is left alone until it is
+cleared.
+*/
+void init_journal(){
+    struct JournalRecord record;
+    next_slot = 0;
+    next_seq = 0;
+    while(next_slot < JOURNAL_SLOTS){
+        xmem_pread(&record, sizeof(record), slot_addr(next_slot));
+        if(record.magic == JOURNAL_FREE){
+            return;
+        }
+        if(record.magic != JOURNAL_MAGIC){
+            log_error("journal: old record layout, clear the journal");
+            next_slot = JOURNAL_SLOTS;
+            return;
+        }
+        next_seq = record.seq + 1;
+        next_slot++;
+    }
+}
+
+/*
+journal_append records a completed run, it returns -1 when the journal
+is full
+*/
+int journal_append(struct Test* test){
+    struct JournalRecord record;
+    if(next_slot >= JOURNAL_SLOTS){
+        log_error("journal is full");
+        return -1;
+    }
+    memset(&record, 0, sizeof(record));
+    record.magic = JOURNAL_MAGIC;
+    record.seq = next_seq;
+    strncpy(record.test, (test->id != NULL) ? test->id : test->name, JOURNAL_ID_SIZE - 1);
+    strncpy(record.api, test->api->name, JOURNAL_API_SIZE - 1);
+    record.ticks = test->completion_time - test->start_time;
+    record.write_bytes = WRITE_BYTES;
+    record.buffer = BUFFER;
+    record.stack_peak = test->stack_peak;
+    record.arena_peak = test->arena_peak;
+    record.total_uj = test->energy.total_uj;
+    record.ops = test->energy.ops;
+    record.written = test->energy.written;
+    record.read = test->energy.read;
+    for(int i = 0; i < PARAM_COUNT; i++){
+        if(PARAMS[i].value == &WRITE_BYTES || PARAMS[i].value == &BUFFER || !param_changed(&PARAMS[i])){
+            continue;
+        }
+        if(record.changed < JOURNAL_PARAMS){
+            record.params[record.changed] = i;
+            record.values[record.changed] = *PARAMS[i].value;
+        }
+        record.changed++;
+    }
+    xmem_pwrite(&record, sizeof(record), slot_addr(next_slot));
+    next_slot++;
+    next_seq++;
+    return 0;
+}
+
+// print_params ends a dumped record with its changed parameters, separated by spaces
+static void print_params(struct JournalRecord* record){
+    for(int i = 0; i < record->changed && i < JOURNAL_PARAMS; i++){
+        if(record->params[i] < PARAM_COUNT){
+            printf("%s%s=%d", (i == 0) ? "" : " ", PARAMS[record->params[i]].name, record->values[i]);
+        }
+    }
+    if(record->changed > JOURNAL_PARAMS){
+        printf(" and %u more", record->changed - JOURNAL_PARAMS);
+    }
+    printf("\n");
+}
+
+void journal_dump(){
+    struct JournalRecord record;
+    printf("journal: %u of %u records\n", next_slot, (unsigned int)JOURNAL_SLOTS);
+    printf("journal,seq,test,api,ticks,write_bytes,buffer,stack,arena,uj,ops,written,read,params\n");
+    for(unsigned int slot = 0; slot < next_slot; slot++){
+        xmem_pread(&record, sizeof(record), slot_addr(slot));
+        if(record.magic != JOURNAL_MAGIC){
+            break;
+        }
+        printf("journal,%u,%s,%s,%lu,%d,%d,%d,%d,%lu,%lu,%lu,%lu,",
+            record.seq,
+            record.test,
+            record.api,
+            record.ticks,
+            record.write_bytes,
+            record.buffer,
+            record.stack_peak,
+            record.arena_peak,
+            record.total_uj,
+            record.ops,
+            record.written,
+            record.read);
+        print_params(&record);
+    }
+}
+
+/*
+journal_clear erases the sectors holding the journal. the first one also
+holds the node id, so everything before JOURNAL_START is read first and
+written back.
+*/
+void journal_clear(){
+    unsigned char keep[JOURNAL_START];
+    xmem_pread(keep, sizeof(keep), 0);
+    for(unsigned long at = 0; at < JOURNAL_END; at += XMEM_ERASE_UNIT_SIZE){
+        xmem_erase(XMEM_ERASE_UNIT_SIZE, at);
+    }
+    xmem_pwrite(keep, sizeof(keep), 0);
+    next_slot = 0;
+    next_seq = 0;
+    log_info("journal cleared");
+}
@@ -0,0 +1,84 @@
+/*
+journal.c keeps the results of completed runs in flash, so they survive a
+disconnected serial line or a reboot.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_JOURNAL_H
+#define WATZBENCH_JOURNAL_H
+#include <stdio.h>
+#include <string.h>
+#include "contiki.h"
+#include "dev/xmem.h"
+
+#include "common.h"
+#include "logfs.h"
+
+/*
+flash layout. the journal lives in the first sector, which neither coffee
+nor logfs use. the bytes before JOURNAL_START hold the node id and are
+kept when the journal is cleared.
+*/
+#ifdef JOURNAL_CONF_START
+#define JOURNAL_START JOURNAL_CONF_START
+#else
+#define JOURNAL_START 256UL
+#endif
+
+#ifdef JOURNAL_CONF_END
+#define JOURNAL_END JOURNAL_CONF_END
+#else
+#define JOURNAL_END (1UL * XMEM_ERASE_UNIT_SIZE)
+#endif
+
+#if JOURNAL_START >= XMEM_ERASE_UNIT_SIZE
+#error "the journal has to start in the first sector"
+#endif
+
+#if JOURNAL_END > LOGFS_START
+#error "the journal overlaps the logfs flash area"
+#endif
+
+#define JOURNAL_MAGIC 0x5743 // "WC", "WB" records had no parameters
+#define JOURNAL_FREE 0xFFFF
+#define JOURNAL_ID_SIZE 24
+#define JOURNAL_API_SIZE 8
+#define JOURNAL_PARAMS 4
+
+/*
+JournalRecord is what is kept of one run. it is written once into an
+erased slot and never changed. the test is recorded by its console name,
+which is unique. besides WRITE_BYTES and BUFFER, the first JOURNAL_PARAMS
+parameters that aren't at their built in value are kept as their index in
+PARAMS and their value, changed counts all of them.
+*/
+struct JournalRecord{
+    unsigned short magic;
+    unsigned short seq;
+    char test[JOURNAL_ID_SIZE];
+    char api[JOURNAL_API_SIZE];
+    unsigned long ticks;
+    int write_bytes;
+    int buffer;
+    int stack_peak;
+    int arena_peak;
+    unsigned long total_uj;
+    unsigned long ops;
+    unsigned long written;
+    unsigned long read;
+    unsigned char changed;
+    unsigned char params[JOURNAL_PARAMS];
+    int values[JOURNAL_PARAMS];
+};
+
+#define JOURNAL_SLOTS ((JOURNAL_END - JOURNAL_START) / sizeof(struct JournalRecord))
+
+struct Test;
+
+void init_journal();
+int journal_append(struct Test*);
+void journal_dump();
+void journal_clear();
+
+#endif //WATZBENCH_JOURNAL_H
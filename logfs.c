@@ -0,0 +1,697 @@
+/*
+logfs.c is a log-structured, append-only storage backend for watzbench. it is
+meant as a purpose-built alternative to coffee for sensor time series, where
+almost every write is an append to the newest file.
+
+layout:
+- the flash area is split into fixed size segments. a file is a chain of
+  segments and every segment belongs to at most one file.
+- segments are handed out round robin from a write head, and a segment is
+  only ever programmed front to back, so an append never seeks or erases.
+- the only index is kept in ram: the owner of each segment and its position
+  within the file. it is rebuilt from scratch on init, logfs is not meant to
+  survive a reboot.
+- each open file keeps its newest bytes in a small ram tail buffer. appends
+  fill it and it is programmed when full, on flush, or on close. reads
+  of recent data are served from the tail buffer or the cached tail segment.
+  every fd has its own stream position, fds of the same file share the
+  open file and its tail buffer.
+- overwriting existing data relocates the affected segment (copy on write).
+- deleting a file marks its segments dead and compacts every erase sector
+  they lived in: live segments are copied out and the sector is erased.
+*/
+#include "logfs.h"
+
+#define SEGMENTS (LOGFS_SIZE / LOGFS_SEGMENT_SIZE)
+#define SECTORS (LOGFS_SIZE / LOGFS_SECTOR_SIZE)
+#define SEGMENTS_PER_SECTOR (LOGFS_SECTOR_SIZE / LOGFS_SEGMENT_SIZE)
+
+#define NO_SEGMENT 0xFFFF
+#define NO_OPEN 0xFF // fd slot is unused
+#define SEG_FREE 0xFF // erased and unused
+#define SEG_DEAD 0xFE // unused, but has to be erased before it can be used
+
+#define COPY_SIZE 32 // chunk size used when relocating segments
+
+#if LOGFS_MAX_FILES >= SEG_DEAD
+#error "LOGFS_MAX_FILES has to fit in a segment owner byte"
+#endif
+
+#if LOGFS_MAX_OPEN >= NO_OPEN
+#error "LOGFS_MAX_OPEN has to fit in an fd byte"
+#endif
+
+struct logfs_file{
+    char name[LOGFS_NAME_SIZE];
+    unsigned long length;   // bytes in the file, including the tail buffer
+    unsigned int tail;      // segment holding the end of the file
+};
+
+struct logfs_open{
+    unsigned char refs;     // fds of the file, 0 if the slot is unused
+    unsigned char file;
+    int buffered;           // bytes in tail that are not programmed yet
+    char tail[LOGFS_TAIL_SIZE];
+};
+
+struct logfs_fd{
+    unsigned char open;     // slot in opens, NO_OPEN if the fd is unused
+    unsigned long pos;      // stream position used by append and read_next
+};
+
+static unsigned char seg_owner[SEGMENTS];
+static unsigned char seg_index[SEGMENTS];
+static struct logfs_file files[LOGFS_MAX_FILES];
+static struct logfs_open opens[LOGFS_MAX_OPEN];
+static struct logfs_fd fds[LOGFS_MAX_FDS];
+static unsigned int head;
+static char copy_buf[COPY_SIZE];
+
+struct LogFSStats logfs_stats;
+
+static unsigned long flushed(unsigned char file);
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Flash Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static unsigned long segment_addr(unsigned int seg){
+    return LOGFS_START + (unsigned long)seg * LOGFS_SEGMENT_SIZE;
+}
+
+static void flash_write(char* buf, int bytes, unsigned long addr){
+    xmem_pwrite(buf, bytes, addr);
+    logfs_stats.bytes_programmed += bytes;
+}
+
+static void flash_read(char* buf, int bytes, unsigned long addr){
+    xmem_pread(buf, bytes, addr);
+    logfs_stats.bytes_read += bytes;
+}
+
+static void erase_sector(unsigned int sector){
+    xmem_erase(LOGFS_SECTOR_SIZE, LOGFS_START + sector * LOGFS_SECTOR_SIZE);
+    unsigned int first = sector * SEGMENTS_PER_SECTOR;
+    for(unsigned int s = first; s < first + SEGMENTS_PER_SECTOR; s++){
+        seg_owner[s] = SEG_FREE;
+    }
+    logfs_stats.sectors_erased++;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Segment Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+allocate_segment hands out the next free segment after the write head and
+assigns it to a file. if nothing is free, a sector that only holds dead
+segments is erased. segments in the avoid sector are never returned, which
+is what compaction needs. returns NO_SEGMENT if the flash is full.
+*/
+static unsigned int allocate_segment(unsigned char file, unsigned char index, unsigned int avoid){
+    unsigned int seg = NO_SEGMENT;
+    for(unsigned int i = 0; i < SEGMENTS && seg == NO_SEGMENT; i++){
+        unsigned int s = (head + i) % SEGMENTS;
+        if(seg_owner[s] == SEG_FREE && s / SEGMENTS_PER_SECTOR != avoid){
+            seg = s;
+        }
+    }
+    for(unsigned int sector = 0; sector < SECTORS && seg == NO_SEGMENT; sector++){
+        if(sector == avoid){
+            continue;
+        }
+        unsigned int first = sector * SEGMENTS_PER_SECTOR;
+        unsigned int dead = 0;
+        for(unsigned int s = first; s < first + SEGMENTS_PER_SECTOR; s++){
+            if(seg_owner[s] == SEG_DEAD){
+                dead++;
+            }
+        }
+        if(dead == SEGMENTS_PER_SECTOR){
+            erase_sector(sector);
+            seg = first;
+        }
+    }
+    if(seg == NO_SEGMENT){
+        return NO_SEGMENT;
+    }
+    seg_owner[seg] = file;
+    seg_index[seg] = index;
+    head = (seg + 1) % SEGMENTS;
+    logfs_stats.segments_allocated++;
+    return seg;
+}
+
+/*
+find_segment looks up the segment holding a part of a file. the tail segment
+is checked first so appends and reads of recent data skip the scan.
+*/
+static unsigned int find_segment(unsigned char file, unsigned char index){
+    unsigned int tail = files[file].tail;
+    if(tail != NO_SEGMENT && seg_index[tail] == index){
+        return tail;
+    }
+    for(unsigned int s = 0; s < SEGMENTS; s++){
+        if(seg_owner[s] == file && seg_index[s] == index){
+            return s;
+        }
+    }
+    return NO_SEGMENT;
+}
+
+/*
+relocate_segment copies the programmed part of a segment to a new segment
+outside the avoid sector, optionally patching bytes of the file in the
+process, then marks the old segment dead. this is used both for overwrites
+(copy on write) and for compaction.
+*/
+static unsigned int relocate_segment(unsigned int old, unsigned int used, unsigned int avoid,
+        unsigned long patch_pos, int patch_bytes, char* patch){
+    unsigned char file = seg_owner[old];
+    unsigned long base = (unsigned long)seg_index[old] * LOGFS_SEGMENT_SIZE;
+    unsigned int seg = allocate_segment(file, seg_index[old], avoid);
+    if(seg == NO_SEGMENT){
+        return NO_SEGMENT;
+    }
+    for(unsigned int at = 0; at < used; at += COPY_SIZE){
+        int chunk = (used - at < COPY_SIZE) ? used - at : COPY_SIZE;
+        flash_read(copy_buf, chunk, segment_addr(old) + at);
+        for(int i = 0; i < chunk; i++){
+            unsigned long pos = base + at + i;
+            if(pos >= patch_pos && pos < patch_pos + patch_bytes){
+                copy_buf[i] = patch[pos - patch_pos];
+            }
+        }
+        flash_write(copy_buf, chunk, segment_addr(seg) + at);
+    }
+    seg_owner[old] = SEG_DEAD;
+    if(files[file].tail == old){
+        files[file].tail = seg;
+    }
+    logfs_stats.segments_relocated++;
+    return seg;
+}
+
+/*
+compact_sector makes the dead segments of a sector reusable. live segments
+are moved out first, if there is not enough room elsewhere the sector is
+left as it is.
+*/
+static void compact_sector(unsigned int sector){
+    unsigned int first = sector * SEGMENTS_PER_SECTOR;
+    unsigned int live = 0;
+    unsigned int dead = 0;
+    unsigned int free_elsewhere = 0;
+    for(unsigned int s = 0; s < SEGMENTS; s++){
+        if(s >= first && s < first + SEGMENTS_PER_SECTOR){
+            if(seg_owner[s] == SEG_DEAD){
+                dead++;
+            }else if(seg_owner[s] != SEG_FREE){
+                live++;
+            }
+        }else if(seg_owner[s] == SEG_FREE){
+            free_elsewhere++;
+        }
+    }
+    if(dead == 0 || live > free_elsewhere){
+        return;
+    }
+    for(unsigned int s = first; s < first + SEGMENTS_PER_SECTOR; s++){
+        if(seg_owner[s] == SEG_DEAD || seg_owner[s] == SEG_FREE){
+            continue;
+        }
+        unsigned long base = (unsigned long)seg_index[s] * LOGFS_SEGMENT_SIZE;
+        unsigned long used = flushed(seg_owner[s]) - base;
+        if(used > LOGFS_SEGMENT_SIZE){
+            used = LOGFS_SEGMENT_SIZE;
+        }
+        relocate_segment(s, used, sector, 0, 0, NULL);
+    }
+    erase_sector(sector);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+File Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static int find_file(char* name){
+    for(int f = 0; f < LOGFS_MAX_FILES; f++){
+        if(files[f].name[0] != '\0' && strcmp(files[f].name, name) == 0){
+            return f;
+        }
+    }
+    return -1;
+}
+
+static int find_or_create_file(char* name){
+    int f = find_file(name);
+    if(f != -1){
+        return f;
+    }
+    if(strlen(name) >= LOGFS_NAME_SIZE){
+        log_error("logfs: file name too long");
+        return -1;
+    }
+    for(f = 0; f < LOGFS_MAX_FILES; f++){
+        if(files[f].name[0] == '\0'){
+            strcpy(files[f].name, name);
+            files[f].length = 0;
+            files[f].tail = NO_SEGMENT;
+            return f;
+        }
+    }
+    log_error("logfs: file table is full, raise LOGFS_CONF_MAX_FILES");
+    return -1;
+}
+
+static struct logfs_fd* get_fd(int fd){
+    if(fd < 0 || fd >= LOGFS_MAX_FDS || fds[fd].open == NO_OPEN){
+        return NULL;
+    }
+    return &fds[fd];
+}
+
+// flushed returns how much of a file is on flash, as opposed to the tail buffer
+static unsigned long flushed(unsigned char file){
+    for(int i = 0; i < LOGFS_MAX_OPEN; i++){
+        if(opens[i].refs != 0 && opens[i].file == file){
+            return files[file].length - opens[i].buffered;
+        }
+    }
+    return files[file].length;
+}
+
+/*
+program writes bytes to the end of the flash resident part of a file,
+allocating new segments as segment boundaries are crossed.
+*/
+static int program(unsigned char file, unsigned long pos, int bytes, char* buf){
+    while(bytes > 0){
+        unsigned char index = pos / LOGFS_SEGMENT_SIZE;
+        unsigned int off = pos % LOGFS_SEGMENT_SIZE;
+        unsigned int seg = find_segment(file, index);
+        if(seg == NO_SEGMENT){
+            seg = allocate_segment(file, index, NO_SEGMENT);
+            if(seg == NO_SEGMENT){
+                log_error("logfs: out of segments");
+                return -1;
+            }
+            files[file].tail = seg;
+        }
+        int chunk = LOGFS_SEGMENT_SIZE - off;
+        if(chunk > bytes){
+            chunk = bytes;
+        }
+        flash_write(buf, chunk, segment_addr(seg) + off);
+        pos += chunk;
+        buf += chunk;
+        bytes -= chunk;
+    }
+    return 0;
+}
+
+// flush_tail keeps the tail buffered if it can't be programmed
+static int flush_tail(struct logfs_open* op){
+    if(op->buffered == 0){
+        return 0;
+    }
+    unsigned long pos = files[op->file].length - op->buffered;
+    if(program(op->file, pos, op->buffered, op->tail) == -1){
+        return -1;
+    }
+    op->buffered = 0;
+    return 0;
+}
+
+static int append_tail(struct logfs_open* op, int bytes, char* buf){
+    struct logfs_file* file = &files[op->file];
+    // large appends skip the tail buffer
+    if(op->buffered == 0 && bytes >= LOGFS_TAIL_SIZE){
+        if(program(op->file, file->length, bytes, buf) == -1){
+            return -1;
+        }
+        file->length += bytes;
+        return 0;
+    }
+    while(bytes > 0){
+        if(op->buffered == LOGFS_TAIL_SIZE && flush_tail(op) == -1){
+            return -1;
+        }
+        int chunk = LOGFS_TAIL_SIZE - op->buffered;
+        if(chunk > bytes){
+            chunk = bytes;
+        }
+        memcpy(op->tail + op->buffered, buf, chunk);
+        op->buffered += chunk;
+        file->length += chunk;
+        buf += chunk;
+        bytes -= chunk;
+    }
+    return 0;
+}
+
+// zero_fill appends zeros to a file up to pos, logfs has no holes
+static int zero_fill(struct logfs_open* op, unsigned long pos){
+    memset(copy_buf, 0, COPY_SIZE);
+    while(files[op->file].length < pos){
+        unsigned long gap = pos - files[op->file].length;
+        if(append_tail(op, (gap < COPY_SIZE) ? gap : COPY_SIZE, copy_buf) == -1){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int overwrite(struct logfs_open* op, unsigned long pos, int bytes, char* buf){
+    unsigned long on_flash = files[op->file].length - op->buffered;
+    // the part of the range still in ram is patched in place
+    if(pos + bytes > on_flash){
+        unsigned long from = (pos > on_flash) ? pos : on_flash;
+        memcpy(op->tail + (from - on_flash), buf + (from - pos), pos + bytes - from);
+        if(pos >= on_flash){
+            return 0;
+        }
+        bytes = on_flash - pos;
+    }
+    // the rest is copied to fresh segments
+    unsigned long at = pos;
+    while(at < pos + bytes){
+        unsigned char index = at / LOGFS_SEGMENT_SIZE;
+        unsigned long base = (unsigned long)index * LOGFS_SEGMENT_SIZE;
+        unsigned long used = on_flash - base;
+        if(used > LOGFS_SEGMENT_SIZE){
+            used = LOGFS_SEGMENT_SIZE;
+        }
+        unsigned int old = find_segment(op->file, index);
+        if(old == NO_SEGMENT || relocate_segment(old, used, NO_SEGMENT, pos, bytes, buf) == NO_SEGMENT){
+            log_error("logfs: overwrite failed");
+            return -1;
+        }
+        at = base + LOGFS_SEGMENT_SIZE;
+    }
+    return 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+API Functions
+
+The below functions are used by the LogFS api in api.c
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*
+logfs_init forgets everything on flash. sectors are erased lazily, the first
+time a segment in them is needed.
+*/
+void logfs_init(){
+    memset(seg_owner, SEG_DEAD, sizeof(seg_owner));
+    memset(seg_index, 0, sizeof(seg_index));
+    memset(files, 0, sizeof(files));
+    memset(opens, 0, sizeof(opens));
+    for(int i = 0; i < LOGFS_MAX_FDS; i++){
+        fds[i].open = NO_OPEN;
+    }
+    memset(&logfs_stats, 0, sizeof(logfs_stats));
+    head = 0;
+}
+
+int logfs_create_file(char* name){
+    energy_storage_begin();
+    int ret = find_or_create_file(name);
+    energy_storage_end(0, 0);
+    return ret;
+}
+
+int logfs_delete_file(char* name){
+    int f = find_file(name);
+    if(f == -1){
+        return -1;
+    }
+    energy_storage_begin();
+    for(int i = 0; i < LOGFS_MAX_FDS; i++){
+        if(fds[i].open != NO_OPEN && opens[fds[i].open].file == f){
+            fds[i].open = NO_OPEN;
+        }
+    }
+    for(int i = 0; i < LOGFS_MAX_OPEN; i++){
+        if(opens[i].refs != 0 && opens[i].file == f){
+            opens[i].refs = 0;
+            opens[i].buffered = 0;
+        }
+    }
+    unsigned char touched[SECTORS];
+    memset(touched, 0, sizeof(touched));
+    for(unsigned int s = 0; s < SEGMENTS; s++){
+        if(seg_owner[s] == f){
+            seg_owner[s] = SEG_DEAD;
+            touched[s / SEGMENTS_PER_SECTOR] = 1;
+        }
+    }
+    files[f].name[0] = '\0';
+
+    for(unsigned int sector = 0; sector < SECTORS; sector++){
+        if(touched[sector]){
+            compact_sector(sector);
+        }
+    }
+    energy_storage_end(0, 0);
+    return 0;
+}
+
+// logfs has a flat namespace
+int logfs_create_dir(char* name){
+    return -1;
+}
+
+int logfs_delete_dir(char* name){
+    return -1;
+}
+
+// the file table is in ram, listing doesn't touch the flash
+int logfs_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    if(strcmp(name, "/") != 0){
+        return -1;
+    }
+    energy_storage_begin();
+    int count = 0;
+    for(int f = 0; f < LOGFS_MAX_FILES; f++){
+        if(files[f].name[0] != '\0'){
+            visit(files[f].name, arg);
+            count++;
+        }
+    }
+    energy_storage_end(0, 0);
+    return count;
+}
+
+/*
+open_fd hands out a new fd at the end of the file. a file that is already
+open shares its open slot, and so its tail buffer, with the new fd.
+*/
+static int open_fd(char* name){
+    int f = find_or_create_file(name);
+    if(f == -1){
+        return -1;
+    }
+    int fd = -1;
+    for(int i = 0; i < LOGFS_MAX_FDS && fd == -1; i++){
+        if(fds[i].open == NO_OPEN){
+            fd = i;
+        }
+    }
+    if(fd == -1){
+        return -1;
+    }
+    int slot = -1;
+    for(int i = 0; i < LOGFS_MAX_OPEN; i++){
+        if(opens[i].refs != 0 && opens[i].file == f){
+            slot = i;
+            break;
+        }
+        if(opens[i].refs == 0 && slot == -1){
+            slot = i;
+        }
+    }
+    if(slot == -1){
+        return -1;
+    }
+    if(opens[slot].refs == 0){
+        opens[slot].file = f;
+        opens[slot].buffered = 0;
+    }
+    opens[slot].refs++;
+    fds[fd].open = slot;
+    fds[fd].pos = files[f].length;
+    return fd;
+}
+
+int logfs_open_get_fd(char* name){
+    energy_storage_begin();
+    int ret = open_fd(name);
+    energy_storage_end(0, 0);
+    return ret;
+}
+
+/*
+write_range appends when pos is the end of the file, which is the fast path.
+writing over existing data relocates segments, and a write past the end of
+the file fills the gap with zeros first since logfs has no holes.
+*/
+static int write_range(struct logfs_fd* fdp, unsigned long pos, int bytes, char* buf){
+    struct logfs_open* op = &opens[fdp->open];
+    if(pos > files[op->file].length && zero_fill(op, pos) == -1){
+        return -1;
+    }
+    unsigned long length = files[op->file].length;
+    fdp->pos = pos + bytes;
+    if(pos < length){
+        int over = bytes;
+        if(pos + over > length){
+            over = length - pos;
+        }
+        if(overwrite(op, pos, over, buf) == -1){
+            return -1;
+        }
+        buf += over;
+        bytes -= over;
+    }
+    if(bytes > 0){
+        return append_tail(op, bytes, buf);
+    }
+    return 0;
+}
+
+// read_range returns the number of bytes read, which is short at the end of the file
+static int read_range(struct logfs_fd* fdp, unsigned long pos, int bytes, char* buf){
+    struct logfs_open* op = &opens[fdp->open];
+    unsigned char file = op->file;
+    unsigned long length = files[file].length;
+    unsigned long on_flash = length - op->buffered;
+    if(pos + bytes > length){
+        bytes = (pos < length) ? length - pos : 0;
+    }
+    int done = 0;
+    while(done < bytes){
+        int chunk;
+        if(pos >= on_flash){
+            chunk = bytes - done;
+            memcpy(buf, op->tail + (pos - on_flash), chunk);
+        }else{
+            unsigned int off = pos % LOGFS_SEGMENT_SIZE;
+            unsigned int seg = find_segment(file, pos / LOGFS_SEGMENT_SIZE);
+            if(seg == NO_SEGMENT){
+                return -1;
+            }
+            chunk = LOGFS_SEGMENT_SIZE - off;
+            if(chunk > bytes - done){
+                chunk = bytes - done;
+            }
+            if(pos + chunk > on_flash){
+                chunk = on_flash - pos;
+            }
+            flash_read(buf, chunk, segment_addr(seg) + off);
+        }
+        pos += chunk;
+        buf += chunk;
+        done += chunk;
+    }
+    fdp->pos = pos;
+    return done;
+}
+
+int logfs_write_at(int fd, int start_pos, int bytes, char* buf){
+    struct logfs_fd* fdp = get_fd(fd);
+    if(fdp == NULL){
+        return -1;
+    }
+    energy_storage_begin();
+    int ret = write_range(fdp, start_pos, bytes, buf);
+    energy_storage_end((ret == -1) ? 0 : bytes, 0);
+    return ret;
+}
+
+int logfs_read_at(int fd, int start_pos, int bytes, char* buf){
+    struct logfs_fd* fdp = get_fd(fd);
+    if(fdp == NULL){
+        return -1;
+    }
+    energy_storage_begin();
+    int ret = read_range(fdp, start_pos, bytes, buf);
+    energy_storage_end(0, ret);
+    return ret;
+}
+
+int logfs_append(int fd, int bytes, char* buf){
+    struct logfs_fd* fdp = get_fd(fd);
+    if(fdp == NULL){
+        return -1;
+    }
+    energy_storage_begin();
+    int ret = write_range(fdp, fdp->pos, bytes, buf);
+    energy_storage_end((ret == -1) ? 0 : bytes, 0);
+    return ret;
+}
+
+int logfs_read_next(int fd, int bytes, char* buf){
+    struct logfs_fd* fdp = get_fd(fd);
+    if(fdp == NULL){
+        return -1;
+    }
+    energy_storage_begin();
+    int ret = read_range(fdp, fdp->pos, bytes, buf);
+    energy_storage_end(0, ret);
+    return ret;
+}
+
+/*
+logfs_flush programs the tail buffer, after this everything written to the
+file is on flash.
+*/
+int logfs_flush(int fd){
+    struct logfs_fd* fdp = get_fd(fd);
+    if(fdp == NULL){
+        return -1;
+    }
+    energy_storage_begin();
+    int ret = flush_tail(&opens[fdp->open]);
+    energy_storage_end(0, 0);
+    return ret;
+}
+
+int logfs_close_fd(int fd){
+    struct logfs_fd* fdp = get_fd(fd);
+    if(fdp == NULL){
+        return -1;
+    }
+    energy_storage_begin();
+    int ret = 0;
+    struct logfs_open* op = &opens[fdp->open];
+    fdp->open = NO_OPEN;
+    op->refs--;
+    // a tail that can't be programmed is lost with the last fd, and the file ends before it
+    if(op->refs == 0 && (ret = flush_tail(op)) == -1){
+        files[op->file].length -= op->buffered;
+        op->buffered = 0;
+    }
+    energy_storage_end(0, 0);
+    return ret;
+}
+
+/*
+logfs_static_ram returns the bytes of ram logfs keeps in its tables and
+buffers, whether or not it is used
+*/
+int logfs_static_ram(){
+    return sizeof(seg_owner) + sizeof(seg_index) + sizeof(files) + sizeof(opens) + sizeof(fds)
+        + sizeof(head) + sizeof(copy_buf) + sizeof(logfs_stats);
+}
+
+/*
+logfs_print_stats prints the flash traffic since the last init, this is
+what should be compared against other filesystems alongside the timing.
+*/
+void logfs_print_stats(){
+    printf("logfs: %lu bytes programmed, %lu bytes read, %u segments allocated, %u relocated, %u sectors erased\n",
+        logfs_stats.bytes_programmed,
+        logfs_stats.bytes_read,
+        logfs_stats.segments_allocated,
+        logfs_stats.segments_relocated,
+        logfs_stats.sectors_erased);
+}
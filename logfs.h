@@ -0,0 +1,107 @@
+/*
+logfs.c is a log-structured, append-only storage backend for watzbench. it
+works directly on the external flash and is exposed to tests through the
+LogFS api (see api.c).
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_LOGFS_H
+#define WATZBENCH_LOGFS_H
+#include <string.h>
+#include "contiki.h"
+#include "dev/xmem.h"
+#include "energy.h"
+
+#include "common.h"
+
+/*
+flash layout. the defaults cover the same area coffee uses on the sky (the
+first sector is left alone), they can be overridden in project-conf.h.
+*/
+#ifdef LOGFS_CONF_START
+#define LOGFS_START LOGFS_CONF_START
+#else
+#define LOGFS_START (64 * 1024UL)
+#endif
+
+#ifdef LOGFS_CONF_SIZE
+#define LOGFS_SIZE LOGFS_CONF_SIZE
+#else
+#define LOGFS_SIZE (15 * 64 * 1024UL)
+#endif
+
+#define LOGFS_SECTOR_SIZE XMEM_ERASE_UNIT_SIZE
+
+#ifdef LOGFS_CONF_SEGMENT_SIZE
+#define LOGFS_SEGMENT_SIZE LOGFS_CONF_SEGMENT_SIZE
+#else
+#define LOGFS_SEGMENT_SIZE 4096UL
+#endif
+
+/*
+number of files, files open at once, fds and size of a filename. the
+verification tests create FILES_TO_CREATE (100) files and WATZ, so the
+default table has room for 101. the directory tests need DIR_FILES
+entries, larger directories need LOGFS_CONF_MAX_FILES raised, up to 253
+at 16 bytes of ram each on the sky.
+*/
+#ifdef LOGFS_CONF_MAX_FILES
+#define LOGFS_MAX_FILES LOGFS_CONF_MAX_FILES
+#else
+#define LOGFS_MAX_FILES 101
+#endif
+
+#ifdef LOGFS_CONF_MAX_OPEN
+#define LOGFS_MAX_OPEN LOGFS_CONF_MAX_OPEN
+#else
+#define LOGFS_MAX_OPEN 4
+#endif
+
+#ifdef LOGFS_CONF_MAX_FDS
+#define LOGFS_MAX_FDS LOGFS_CONF_MAX_FDS
+#else
+#define LOGFS_MAX_FDS 8
+#endif
+
+// Names are up to LOGFS_NAME_SIZE - 1 characters, longer ones are refused
+#define LOGFS_NAME_SIZE 10
+
+// Bytes of each open file that are kept in ram before being programmed
+#ifdef LOGFS_CONF_TAIL_SIZE
+#define LOGFS_TAIL_SIZE LOGFS_CONF_TAIL_SIZE
+#else
+#define LOGFS_TAIL_SIZE 128
+#endif
+
+/*
+LogFSStats counts the flash traffic caused by logfs since the last init.
+*/
+struct LogFSStats{
+    unsigned long bytes_programmed;
+    unsigned long bytes_read;
+    unsigned int segments_allocated;
+    unsigned int segments_relocated;
+    unsigned int sectors_erased;
+};
+
+extern struct LogFSStats logfs_stats;
+
+void logfs_init();
+int logfs_create_file(char*);
+int logfs_delete_file(char*);
+int logfs_create_dir(char*);
+int logfs_delete_dir(char*);
+int logfs_list_dir(char*, void (*)(char*, void*), void*);
+int logfs_open_get_fd(char*);
+int logfs_write_at(int, int, int, char*);
+int logfs_read_at(int, int, int, char*);
+int logfs_close_fd(int);
+int logfs_append(int, int, char*);
+int logfs_read_next(int, int, char*);
+int logfs_flush(int);
+
+int logfs_static_ram();
+void logfs_print_stats();
+
+#endif //WATZBENCH_LOGFS_H
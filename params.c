@@ -0,0 +1,98 @@
+/*
+params.c is the table of parameters the console can set.
+
+the parameters are the globals in watzbench.c, which keep their names
+here. a parameter that isn't in the table can only be changed by a
+rebuild.
+*/
+#include "params.h"
+#include "test.h"
+#include "compress.h"
+#include "verify.h"
+#include "archive.h"
+#include "database.h"
+#ifdef WATZBENCH_HOST
+#include "scale.h"
+#endif
+
+const struct Param PARAMS[] = {
+    {"WRITE_BYTES", &WRITE_BYTES, 1, INT_MAX, "bytes written per file or pass"},
+    {"BUFFER", &BUFFER, 1, INT_MAX, "bytes per api call"},
+    {"FLUSH_INTERVAL", &FLUSH_INTERVAL, 0, INT_MAX, "records between flushes, 0 never flushes"},
+    {"RECORD_SIZE", &RECORD_SIZE, 1, INT_MAX, "record size of the batching and mixed tests"},
+    {"BATCH_RECORDS", &BATCH_RECORDS, 1, INT_MAX, "records per vectored call"},
+    {"ACCESS_PATTERN", &ACCESS_PATTERN, PATTERN_UNIFORM, PATTERN_STRIDE, "0 uniform, 1 zipf, 2 hotspot, 3 stride"},
+    {"ACCESS_SEED", &ACCESS_SEED, 0, INT_MAX, "seed of the access pattern"},
+    {"ACCESS_STRIDE", &ACCESS_STRIDE, 1, INT_MAX, "stride of the stride pattern"},
+    {"MIX_WRITE_PERCENT", &MIX_WRITE_PERCENT, 0, 100, "share of writes in the mixed workload"},
+    {"MIX_WORKING_SET", &MIX_WORKING_SET, 1, INT_MAX, "file size of the mixed workload"},
+    {"MIX_OPS", &MIX_OPS, 1, INT_MAX, "operations in the mixed workload"},
+    {"INGEST_SENSORS", &INGEST_SENSORS, 1, INT_MAX, "files the ingest test appends to"},
+    {"DIR_FILES", &DIR_FILES, 1, INT_MAX, "files in the root for the directory tests"},
+    {"DATA_KIND", &DATA_KIND, DATA_CONSTANT, DATA_TEXT, "0 constant, 1 random, 2 sensor, 3 text"},
+    {"DATA_SEED", &DATA_SEED, 0, INT_MAX, "seed of the random data kinds"},
+    {"VERIFY", &VERIFY, 0, 1, "1 checks every read of the job tests with a crc"},
+    {"ARCHIVE_INTERVAL", &ARCHIVE_INTERVAL, 1, INT_MAX, "seconds between archive records"},
+    {"ARCHIVE_INDEX_EVERY", &ARCHIVE_INDEX_EVERY, 1, INT_MAX, "archive records per index entry"},
+    {"ARCHIVE_RECENT", &ARCHIVE_RECENT, 1, INT_MAX, "minutes of the recent archive query"},
+#ifdef WATZBENCH_ANTELOPE
+    {"DB_ROWS", &DB_ROWS, 1, INT_MAX, "rows of the database tests"},
+    {"DB_RANGE", &DB_RANGE, 1, INT_MAX, "rows of a range select"},
+#endif
+    {"COMPRESS_MODE", &COMPRESS_MODE, COMPRESS_STORE, COMPRESS_DELTA, "0 store, 1 lz, 2 delta"},
+#ifdef WATZBENCH_HOST
+    {"POSIX_DIRECT", &POSIX_DIRECT, 0, 1, "1 opens Posix files with O_DIRECT"},
+    {"POSIX_SYNC", &POSIX_SYNC, POSIX_SYNC_NEVER, POSIX_SYNC_WRITE, "0 never, 1 on flush and close, 2 every write"},
+    {"SCALE_SHARED", &SCALE_SHARED, 0, 1, "1 makes scale threads share files"},
+    {"RING_DEPTH", &RING_DEPTH, 1, INT_MAX, "writes the Ring backend submits at once"},
+    {"RING_POOL", &RING_POOL, 0, 1, "1 makes Ring use its thread pool instead of io_uring"},
+#endif
+};
+
+const int PARAM_COUNT = sizeof(PARAMS) / sizeof(struct Param);
+
+static int defaults[sizeof(PARAMS) / sizeof(struct Param)];
+
+/*
+init_params is called when the program starts, it keeps the value every
+parameter is built with so the journal can tell which ones a run changed
+*/
+void init_params(){
+    for(int i = 0; i < PARAM_COUNT; i++){
+        defaults[i] = *PARAMS[i].value;
+    }
+}
+
+/*
+param_find returns the parameter with the given name, or NULL
+*/
+const struct Param* param_find(char* name){
+    for(int i = 0; i < PARAM_COUNT; i++){
+        if(strcmp(PARAMS[i].name, name) == 0){
+            return &PARAMS[i];
+        }
+    }
+    return NULL;
+}
+
+// param_changed is whether a parameter is set to something else than it was built with
+int param_changed(const struct Param* param){
+    return *param->value != defaults[param - PARAMS];
+}
+
+/*
+param_check returns -1 and says why if a parameter can't take a value.
+sizes and counts have to be at least 1, a 0 would divide by zero or
+never finish.
+*/
+int param_check(const struct Param* param, int value){
+    if(value < param->min || value > param->max){
+        printf("%s has to be from %d to %d\n", param->name, param->min, param->max);
+        return -1;
+    }
+    return 0;
+}
+
+void param_print(const struct Param* param){
+    printf("%s = %d (%s)\n", param->name, *param->value, param->help);
+}
@@ -0,0 +1,34 @@
+/*
+params.c lists the testing parameters that can be changed at runtime.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_PARAMS_H
+#define WATZBENCH_PARAMS_H
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+Param is a runtime parameter, value points at the global defined in
+watzbench.c. it can be set to anything from min to max.
+*/
+struct Param{
+    const char* name;
+    int* value;
+    int min;
+    int max;
+    const char* help;
+};
+
+extern const struct Param PARAMS[];
+extern const int PARAM_COUNT;
+
+void init_params();
+const struct Param* param_find(char* name);
+int param_changed(const struct Param*);
+int param_check(const struct Param*, int value);
+void param_print(const struct Param*);
+
+#endif //WATZBENCH_PARAMS_H
@@ -0,0 +1,93 @@
+/*
+pattern.c generates the offsets used by tests that don't access files
+sequentially.
+
+offsets are generated into an array before a test starts (usually into
+TestParams.rands in the prepare function), so no random number generation
+happens while a test is timed. pattern_fill always restarts its generator
+from ACCESS_SEED, which means every backend sees exactly the same sequence
+for the same parameters. the generator is private to this file so other
+users of random_rand can't shift the sequence.
+*/
+#include "pattern.h"
+
+// uint32_t, an unsigned long is 64 bits on the host and would give other sequences
+static THREAD_LOCAL uint32_t state;
+
+void pattern_seed(unsigned int seed){
+    state = seed;
+}
+
+/*
+pattern_rand is a 32 bit linear congruential generator, returning its
+upper 16 bits
+*/
+unsigned int pattern_rand(){
+    state = state * 1664525UL + 1013904223UL;
+    return (uint16_t)(state >> 16);
+}
+
+// a random number in [0, n) for n up to 2^32
+static unsigned long rand_below(unsigned long n){
+    unsigned long r = ((unsigned long)pattern_rand() << 16) | pattern_rand();
+    return r % n;
+}
+
+static int zipf(int range){
+    int buckets = (range < PATTERN_ZIPF_BUCKETS) ? range : PATTERN_ZIPF_BUCKETS;
+    unsigned long total = 0;
+    for(int k = 0; k < buckets; k++){
+        total += 65535UL / (k + 1);
+    }
+    unsigned long r = rand_below(total);
+    int k = 0;
+    while(r >= 65535UL / (k + 1)){
+        r -= 65535UL / (k + 1);
+        k++;
+    }
+    int size = range / buckets;
+    int start = k * size;
+    if(k == buckets - 1){
+        size = range - start; // the last bucket takes the remainder
+    }
+    return start + rand_below(size);
+}
+
+static int hotspot(int range){
+    int hot = ((long)range * PATTERN_HOT_SIZE) / 100;
+    if(hot < 1){
+        hot = 1;
+    }
+    if(rand_below(100) < PATTERN_HOT_ACCESSES || hot == range){
+        return rand_below(hot);
+    }
+    return hot + rand_below(range - hot);
+}
+
+/*
+pattern_fill writes count offsets in [0, range) to offsets, following
+ACCESS_PATTERN.
+*/
+void pattern_fill(int* offsets, int count, int range){
+    pattern_seed(ACCESS_SEED);
+    for(int i = 0; i < count; i++){
+        if(range <= 0){
+            offsets[i] = 0;
+            continue;
+        }
+        switch(ACCESS_PATTERN){
+            case PATTERN_ZIPF:
+                offsets[i] = zipf(range);
+                break;
+            case PATTERN_HOTSPOT:
+                offsets[i] = hotspot(range);
+                break;
+            case PATTERN_STRIDE:
+                offsets[i] = ((long)i * ACCESS_STRIDE) % range;
+                break;
+            default:
+                offsets[i] = rand_below(range);
+                break;
+        }
+    }
+}
@@ -0,0 +1,33 @@
+/*
+pattern.c generates the offsets used by tests that don't access files
+sequentially.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_PATTERN_H
+#define WATZBENCH_PATTERN_H
+#include <stdint.h>
+#include "common.h"
+
+#define PATTERN_UNIFORM 0   // every offset is equally likely
+#define PATTERN_ZIPF 1      // a few offsets get most of the accesses
+#define PATTERN_HOTSPOT 2   // most accesses go to a small region
+#define PATTERN_STRIDE 3    // sequential with a fixed stride, wrapping around
+
+// Zipf: the range is split into this many buckets, bucket k gets 1/(k+1) of the weight
+#define PATTERN_ZIPF_BUCKETS 32
+
+// Hotspot: this percentage of accesses go to the first PATTERN_HOT_SIZE percent
+#define PATTERN_HOT_ACCESSES 90
+#define PATTERN_HOT_SIZE 10
+
+extern int ACCESS_PATTERN;
+extern int ACCESS_SEED;
+extern int ACCESS_STRIDE;
+
+void pattern_seed(unsigned int seed);
+unsigned int pattern_rand();
+void pattern_fill(int* offsets, int count, int range);
+
+#endif //WATZBENCH_PATTERN_H
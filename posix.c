@@ -0,0 +1,278 @@
+/*
+posix.c is the Posix backend, files in POSIX_ROOT accessed with pread and
+pwrite.
+
+like every watzbench fd, a posix fd has a stream position (see api.h).
+pread and pwrite don't move the kernel's file offset, so the position is
+kept here for each fd.
+
+POSIX_DIRECT opens files with O_DIRECT, which bypasses the page cache
+but only takes transfers aligned to POSIX_ALIGN in memory, position and
+length. unaligned calls go through an aligned bounce buffer: the covering
+blocks are read, patched and written back, and the file is truncated to
+its real length afterwards. POSIX_SYNC picks when data is forced to the
+device (see posix.h).
+*/
+#define _GNU_SOURCE
+#include "posix.h"
+#include "api.h"
+
+static off_t positions[POSIX_MAX_FDS];
+static THREAD_LOCAL char* bounce;
+static THREAD_LOCAL int bounce_size;
+static THREAD_LOCAL char* space = ""; // Prefix of every name, see posix_namespace
+
+// posix_path puts the path of name in POSIX_ROOT into buf
+void posix_path(char* buf, char* name){
+    snprintf(buf, POSIX_PATH_SIZE, "%s/%s%s", POSIX_ROOT, space, name);
+}
+
+/*
+posix_namespace sets a prefix for the names used by the calling thread,
+so threads running the same test don't share files (see scale.c)
+*/
+void posix_namespace(char* prefix){
+    space = prefix;
+}
+
+static int aligned(off_t pos, int bytes, char* buf){
+    return pos % POSIX_ALIGN == 0 && bytes % POSIX_ALIGN == 0 && (unsigned long)buf % POSIX_ALIGN == 0;
+}
+
+// get_bounce returns an aligned buffer of at least bytes
+static char* get_bounce(int bytes){
+    if(bytes > bounce_size){
+        free(bounce);
+        bounce = NULL;
+        bounce_size = 0;
+        if(posix_memalign((void**)&bounce, POSIX_ALIGN, bytes) != 0){
+            return NULL;
+        }
+        bounce_size = bytes;
+    }
+    return bounce;
+}
+
+static int sync_write(int fd){
+    if(POSIX_SYNC == POSIX_SYNC_WRITE){
+        return fdatasync(fd);
+    }
+    return 0;
+}
+
+/*
+pwrite_all writes bytes at pos, going through the bounce buffer when
+O_DIRECT can't take the call as it is
+*/
+static int pwrite_all(int fd, off_t pos, int bytes, char* buf){
+    if(!POSIX_DIRECT || aligned(pos, bytes, buf)){
+        return (pwrite(fd, buf, bytes, pos) == bytes) ? 0 : -1;
+    }
+    struct stat st;
+    if(fstat(fd, &st) == -1){
+        return -1;
+    }
+    off_t first = pos - pos % POSIX_ALIGN;
+    off_t last = pos + bytes;
+    int span = ((last - first + POSIX_ALIGN - 1) / POSIX_ALIGN) * POSIX_ALIGN;
+    char* b = get_bounce(span);
+    if(b == NULL){
+        return -1;
+    }
+    memset(b, 0, span);
+    if(pread(fd, b, span, first) == -1){
+        return -1;
+    }
+    memcpy(b + (pos - first), buf, bytes);
+    if(pwrite(fd, b, span, first) != span){
+        return -1;
+    }
+    return ftruncate(fd, (last > st.st_size) ? last : st.st_size);
+}
+
+static int pread_all(int fd, off_t pos, int bytes, char* buf){
+    if(!POSIX_DIRECT || aligned(pos, bytes, buf)){
+        return pread(fd, buf, bytes, pos);
+    }
+    off_t first = pos - pos % POSIX_ALIGN;
+    int span = ((pos + bytes - first + POSIX_ALIGN - 1) / POSIX_ALIGN) * POSIX_ALIGN;
+    char* b = get_bounce(span);
+    if(b == NULL){
+        return -1;
+    }
+    int got = pread(fd, b, span, first);
+    if(got == -1){
+        return -1;
+    }
+    got -= pos - first;
+    if(got < 0){
+        got = 0;
+    }
+    if(got > bytes){
+        got = bytes;
+    }
+    memcpy(buf, b + (pos - first), got);
+    return got;
+}
+
+// the position table, the bounce buffer is allocated on first use
+int posix_static_ram(){
+    return sizeof(positions);
+}
+
+void posix_init(){
+    mkdir(POSIX_ROOT, 0755);
+}
+
+int posix_create_file(char* name){
+    char p[POSIX_PATH_SIZE];
+    posix_path(p, name);
+    energy_storage_begin();
+    int fd = open(p, O_WRONLY | O_CREAT, 0644);
+    if(fd != -1){
+        close(fd);
+    }
+    energy_storage_end(0, 0);
+    return (fd == -1) ? -1 : 0;
+}
+
+int posix_delete_file(char* name){
+    char p[POSIX_PATH_SIZE];
+    posix_path(p, name);
+    energy_storage_begin();
+    int err = unlink(p);
+    energy_storage_end(0, 0);
+    return err;
+}
+
+int posix_create_dir(char* name){
+    char p[POSIX_PATH_SIZE];
+    posix_path(p, name);
+    energy_storage_begin();
+    int err = mkdir(p, 0755);
+    energy_storage_end(0, 0);
+    return err;
+}
+
+int posix_delete_dir(char* name){
+    char p[POSIX_PATH_SIZE];
+    posix_path(p, name);
+    energy_storage_begin();
+    int err = rmdir(p);
+    energy_storage_end(0, 0);
+    return err;
+}
+
+/*
+posix_list_dir lists a directory under POSIX_ROOT. the namespace of the
+thread is a prefix, not a directory, so only names starting with it are
+listed, without it.
+*/
+int posix_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    char p[POSIX_PATH_SIZE];
+    snprintf(p, sizeof(p), "%s/%s", POSIX_ROOT, name);
+    energy_storage_begin();
+    DIR* dir = opendir(p);
+    if(dir == NULL){
+        energy_storage_end(0, 0);
+        return -1;
+    }
+    int count = 0;
+    int prefix = strlen(space);
+    struct dirent* e;
+    while((e = readdir(dir)) != NULL){
+        if(e->d_name[0] != '.' && strncmp(e->d_name, space, prefix) == 0){
+            visit(e->d_name + prefix, arg);
+            count++;
+        }
+    }
+    closedir(dir);
+    energy_storage_end(0, 0);
+    return count;
+}
+
+int posix_open_get_fd(char* name){
+    char p[POSIX_PATH_SIZE];
+    posix_path(p, name);
+    energy_storage_begin();
+    int fd = open(p, O_RDWR | O_CREAT | (POSIX_DIRECT ? O_DIRECT : 0), 0644);
+    if(fd >= POSIX_MAX_FDS){
+        close(fd);
+        fd = -1;
+    }
+    if(fd != -1){
+        positions[fd] = lseek(fd, 0, SEEK_END);
+    }
+    energy_storage_end(0, 0);
+    return fd;
+}
+
+int posix_write_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
+    int err = pwrite_all(fd, start_pos, bytes, buf);
+    if(err == 0){
+        positions[fd] = start_pos + bytes;
+        err = sync_write(fd);
+    }
+    energy_storage_end((err == 0) ? bytes : 0, 0);
+    return err;
+}
+
+int posix_read_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
+    int got = pread_all(fd, start_pos, bytes, buf);
+    if(got != -1){
+        positions[fd] = start_pos + got;
+    }
+    energy_storage_end(0, got);
+    return got;
+}
+
+int posix_close_fd(int fd){
+    energy_storage_begin();
+    if(POSIX_SYNC != POSIX_SYNC_NEVER){
+        fdatasync(fd);
+    }
+    int err = close(fd);
+    energy_storage_end(0, 0);
+    return err;
+}
+
+int posix_append(int fd, int bytes, char* buf){
+    return posix_write_at(fd, positions[fd], bytes, buf);
+}
+
+int posix_read_next(int fd, int bytes, char* buf){
+    energy_storage_begin();
+    int got = pread_all(fd, positions[fd], bytes, buf);
+    if(got != -1){
+        positions[fd] += got;
+    }
+    energy_storage_end(0, got);
+    return got;
+}
+
+int posix_flush(int fd){
+    energy_storage_begin();
+    int err = 0;
+    if(POSIX_SYNC != POSIX_SYNC_NEVER){
+        err = fdatasync(fd);
+    }
+    energy_storage_end(0, 0);
+    return err;
+}
+
+// the kernel does the batching, the loops keep the position rules
+int posix_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int err = writev_loop(posix_write_at, fd, start_pos, vec, count);
+    energy_storage_end(0, 0);
+    return err;
+}
+
+int posix_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int got = readv_loop(posix_read_at, fd, start_pos, vec, count);
+    energy_storage_end(0, 0);
+    return got;
+}
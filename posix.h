@@ -0,0 +1,58 @@
+/*
+posix.c is a backend for the host build that uses posix files directly,
+so the same tests can run on a linux gateway. it is only compiled into
+the host build (see Makefile.host).
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_POSIX_H
+#define WATZBENCH_POSIX_H
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "energy.h"
+
+// Directory the files are kept in, and the most fds tracked
+#define POSIX_ROOT "watzbench.posix"
+#define POSIX_MAX_FDS 256
+#define POSIX_PATH_SIZE 64
+
+// O_DIRECT transfers have to be aligned to this
+#define POSIX_ALIGN 4096
+
+// Sync policies for POSIX_SYNC
+#define POSIX_SYNC_NEVER 0  // leave it to the page cache
+#define POSIX_SYNC_FLUSH 1  // fdatasync on flush and close
+#define POSIX_SYNC_WRITE 2  // fdatasync after every write
+
+extern int POSIX_DIRECT;
+extern int POSIX_SYNC;
+
+struct IOVec;
+
+void posix_path(char*, char*);
+void posix_namespace(char*);
+int posix_static_ram();
+void posix_init();
+int posix_create_file(char*);
+int posix_delete_file(char*);
+int posix_create_dir(char*);
+int posix_delete_dir(char*);
+int posix_list_dir(char*, void (*)(char*, void*), void*);
+int posix_open_get_fd(char*);
+int posix_write_at(int, int, int, char*);
+int posix_read_at(int, int, int, char*);
+int posix_close_fd(int);
+int posix_append(int, int, char*);
+int posix_read_next(int, int, char*);
+int posix_flush(int);
+int posix_writev_at(int, int, struct IOVec*, int);
+int posix_readv_at(int, int, struct IOVec*, int);
+
+#endif //WATZBENCH_POSIX_H
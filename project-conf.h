@@ -42,5 +42,25 @@
 #define RF_CORE_CONF_CHANNEL                 25
 #define RF_BLE_CONF_ENABLED                   1
 /*---------------------------------------------------------------------------*/
+/* Energest, the flash read and write times come from the xmem driver, see energy.c */
+#define ENERGEST_CONF_ON                      1
+/*---------------------------------------------------------------------------*/
+/*
+ * Smaller watzbench buffers for the 10K of ram on the sky, the host build
+ * keeps the defaults. Worked out by hand with 16 bit ints, what is left:
+ *   arena 3072 (the random tests peak at about 2.8K with BUFFER 1024)
+ *   LogFS 2464 (the 101 entry file table is 1616 of it)
+ *   Traced 660, Compressed 317, Instrumented 224, Coffee staging 256
+ *   the painted stack, 512
+ * the startup banner prints the static ram of the arena and the backends,
+ * check it against msp430-size when the build changes.
+ */
+#ifndef WATZBENCH_HOST
+#define ARENA_CONF_SIZE                    3072
+#define LOGFS_CONF_TAIL_SIZE                 64
+#define TRACE_CONF_SIZE                     512
+#define FOOTPRINT_CONF_STACK_DEPTH          512
+#endif
+/*---------------------------------------------------------------------------*/
 #endif /* PROJECT_CONF_H_ */
 /*---------------------------------------------------------------------------*/
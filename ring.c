@@ -0,0 +1,426 @@
+/*
+ring.c is the Ring backend, files in POSIX_ROOT written in batches.
+
+with the Posix backend every write_at is one pwrite system call. here
+writes are copied into a slot and queued instead, and once RING_DEPTH
+slots are queued the whole batch is handed to the kernel at once and
+all of its completions are reaped before the call returns. RING_DEPTH 1
+is the synchronous case, one submission per write.
+
+the batch goes through io_uring when the kernel allows it, with one
+io_uring_enter per batch. otherwise, or when RING_POOL is set, a pool of
+RING_THREADS threads does the pwrites of a batch in parallel.
+
+a few rules keep the stream semantics of api.h:
+ - a write that overlaps a queued write to the same fd submits the queue
+   first, since neither engine keeps the order inside a batch
+ - reads, open, flush and close submit the queue before they run, so
+   they always see every write made before them. readv_at queues all of
+   its reads as one batch
+ - a queued write that fails is reported by the call that submitted it,
+   which may be a later write, flush or close on any fd
+flush and close follow POSIX_SYNC, a POSIX_SYNC of 2 syncs on flush and
+close like 1 does.
+*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "ring.h"
+#include "api.h"
+
+#define SLOT_WRITE 0
+#define SLOT_READ 1
+
+/*
+Slot is one queued operation. writes are copied into stage, which grows
+to the largest write seen, reads go straight to the caller's buffer.
+*/
+struct Slot{
+    unsigned char op;
+    int fd;
+    off_t pos;
+    int bytes;
+    char* buf;
+    char* stage;
+    int stage_size;
+    int result; // bytes moved, or -errno
+};
+
+static struct Slot slots[RING_MAX_DEPTH];
+static int pending; // Slots queued
+static int read_done; // Bytes read by the batches since it was reset
+static off_t positions[POSIX_MAX_FDS];
+static int ready;
+
+static int depth(){
+    if(RING_DEPTH < 1){
+        return 1;
+    }
+    return (RING_DEPTH > RING_MAX_DEPTH) ? RING_MAX_DEPTH : RING_DEPTH;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+io_uring
+
+there is no liburing on the gateway, so the rings are set up and mapped
+with the raw system calls. this process is the only producer of the
+submission ring and the only consumer of the completion ring.
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static struct{
+    int fd;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+} uring = {.fd = -1};
+
+static void uring_setup(){
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = syscall(__NR_io_uring_setup, RING_MAX_DEPTH, &p);
+    if(fd < 0){
+        return;
+    }
+    size_t sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if(p.features & IORING_FEAT_SINGLE_MMAP){
+        sq_len = cq_len = (sq_len > cq_len) ? sq_len : cq_len;
+    }
+    char* sq = mmap(NULL, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    char* cq = sq;
+    if(!(p.features & IORING_FEAT_SINGLE_MMAP) && sq != MAP_FAILED){
+        cq = mmap(NULL, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    void* sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if(sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED){
+        close(fd);
+        return;
+    }
+    uring.sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    uring.sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    uring.sq_array = (unsigned*)(sq + p.sq_off.array);
+    uring.sqes = (struct io_uring_sqe*)sqes;
+    uring.cq_head = (unsigned*)(cq + p.cq_off.head);
+    uring.cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    uring.cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    uring.cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    uring.fd = fd;
+}
+
+// uring_run submits slots 0 to n - 1 and waits for all of them
+static int uring_run(int n){
+    unsigned tail = *uring.sq_tail;
+    for(int i = 0; i < n; i++){
+        unsigned idx = tail & *uring.sq_mask;
+        struct io_uring_sqe* sqe = &uring.sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = (slots[i].op == SLOT_WRITE) ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd = slots[i].fd;
+        sqe->off = slots[i].pos;
+        sqe->addr = (unsigned long)((slots[i].op == SLOT_WRITE) ? slots[i].stage : slots[i].buf);
+        sqe->len = slots[i].bytes;
+        sqe->user_data = i;
+        uring.sq_array[idx] = idx;
+        tail++;
+    }
+    __atomic_store_n(uring.sq_tail, tail, __ATOMIC_RELEASE);
+    int submitted = 0;
+    int reaped = 0;
+    while(reaped < n){
+        int r = syscall(__NR_io_uring_enter, uring.fd, n - submitted, n - reaped, IORING_ENTER_GETEVENTS, NULL, 0);
+        if(r < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        submitted += r;
+        unsigned head = *uring.cq_head;
+        while(head != __atomic_load_n(uring.cq_tail, __ATOMIC_ACQUIRE)){
+            struct io_uring_cqe* cqe = &uring.cqes[head & *uring.cq_mask];
+            slots[cqe->user_data].result = cqe->res;
+            reaped++;
+            head++;
+        }
+        __atomic_store_n(uring.cq_head, head, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Thread Pool
+
+the fallback engine. the workers take slots of the current batch in
+order, the submitting thread sleeps until the batch has completed.
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static pthread_t threads[RING_THREADS];
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+static int batch; // Slots in the current batch
+static int next; // Next slot to take
+static int completed; // Slots of the batch completed
+
+static void slot_run(struct Slot* slot){
+    int r;
+    if(slot->op == SLOT_WRITE){
+        r = pwrite(slot->fd, slot->stage, slot->bytes, slot->pos);
+    }else{
+        r = pread(slot->fd, slot->buf, slot->bytes, slot->pos);
+    }
+    slot->result = (r == -1) ? -errno : r;
+}
+
+static void* pool_worker(void* arg){
+    pthread_mutex_lock(&pool_lock);
+    while(1){
+        while(next >= batch){
+            pthread_cond_wait(&pool_work, &pool_lock);
+        }
+        int i = next++;
+        pthread_mutex_unlock(&pool_lock);
+        slot_run(&slots[i]);
+        pthread_mutex_lock(&pool_lock);
+        completed++;
+        if(completed == batch){
+            pthread_cond_signal(&pool_done);
+        }
+    }
+    return NULL;
+}
+
+static void pool_setup(){
+    for(int i = 0; i < RING_THREADS; i++){
+        pthread_create(&threads[i], NULL, pool_worker, NULL);
+    }
+}
+
+static int pool_run(int n){
+    pthread_mutex_lock(&pool_lock);
+    batch = n;
+    next = 0;
+    completed = 0;
+    pthread_cond_broadcast(&pool_work);
+    while(completed < n){
+        pthread_cond_wait(&pool_done, &pool_lock);
+    }
+    batch = 0;
+    next = 0;
+    pthread_mutex_unlock(&pool_lock);
+    return 0;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Queue
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/*
+drain submits every queued slot and reaps the completions. it returns -1
+if any of them failed or a write came up short.
+*/
+static int drain(){
+    if(pending == 0){
+        return 0;
+    }
+    int err = (uring.fd != -1 && !RING_POOL) ? uring_run(pending) : pool_run(pending);
+    for(int i = 0; i < pending; i++){
+        if(slots[i].result < 0 || (slots[i].op == SLOT_WRITE && slots[i].result != slots[i].bytes)){
+            err = -1;
+        }else if(slots[i].op == SLOT_READ){
+            read_done += slots[i].result;
+        }
+    }
+    pending = 0;
+    return err;
+}
+
+static int overlaps(int fd, off_t pos, int bytes){
+    for(int i = 0; i < pending; i++){
+        if(slots[i].fd == fd && pos < slots[i].pos + slots[i].bytes && slots[i].pos < pos + bytes){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int queue_write(int fd, off_t pos, int bytes, char* buf){
+    int err = 0;
+    if(overlaps(fd, pos, bytes)){
+        err = drain();
+    }
+    struct Slot* slot = &slots[pending];
+    if(bytes > slot->stage_size){
+        char* stage = realloc(slot->stage, bytes);
+        if(stage == NULL){
+            return -1;
+        }
+        slot->stage = stage;
+        slot->stage_size = bytes;
+    }
+    memcpy(slot->stage, buf, bytes);
+    slot->op = SLOT_WRITE;
+    slot->fd = fd;
+    slot->pos = pos;
+    slot->bytes = bytes;
+    pending++;
+    positions[fd] = pos + bytes;
+    if(pending >= depth() && drain() == -1){
+        err = -1;
+    }
+    return err;
+}
+
+// reads go out with the next drain, which the caller does
+static int queue_read(int fd, off_t pos, int bytes, char* buf){
+    int err = 0;
+    if(pending >= depth()){
+        err = drain();
+    }
+    struct Slot* slot = &slots[pending];
+    slot->op = SLOT_READ;
+    slot->fd = fd;
+    slot->pos = pos;
+    slot->bytes = bytes;
+    slot->buf = buf;
+    pending++;
+    return err;
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Ring Functions
+
+creating and deleting files and directories is left to the Posix
+functions, only the fds are the Ring backend's own.
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+char* ring_engine(){
+    return (uring.fd != -1 && !RING_POOL) ? "io_uring" : "threads";
+}
+
+// the slots and the position table, stages are allocated as writes need them
+int ring_static_ram(){
+    return sizeof(slots) + sizeof(positions);
+}
+
+void ring_init(){
+    posix_init();
+    if(!ready){
+        uring_setup();
+        pool_setup();
+        ready = 1;
+    }
+}
+
+int ring_open_get_fd(char* name){
+    char p[POSIX_PATH_SIZE];
+    posix_path(p, name);
+    energy_storage_begin();
+    drain();
+    int fd = open(p, O_RDWR | O_CREAT, 0644);
+    if(fd >= POSIX_MAX_FDS){
+        close(fd);
+        fd = -1;
+    }
+    if(fd != -1){
+        positions[fd] = lseek(fd, 0, SEEK_END);
+    }
+    energy_storage_end(0, 0);
+    return fd;
+}
+
+int ring_write_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
+    int err = queue_write(fd, start_pos, bytes, buf);
+    energy_storage_end(bytes, 0);
+    return err;
+}
+
+int ring_read_at(int fd, int start_pos, int bytes, char* buf){
+    energy_storage_begin();
+    int err = drain();
+    read_done = 0;
+    queue_read(fd, start_pos, bytes, buf);
+    if(drain() == -1){
+        err = -1;
+    }
+    positions[fd] = start_pos + read_done;
+    energy_storage_end(0, read_done);
+    return (err == -1) ? -1 : read_done;
+}
+
+int ring_close_fd(int fd){
+    energy_storage_begin();
+    int err = drain();
+    if(POSIX_SYNC != POSIX_SYNC_NEVER){
+        fdatasync(fd);
+    }
+    if(close(fd) == -1){
+        err = -1;
+    }
+    energy_storage_end(0, 0);
+    return err;
+}
+
+int ring_append(int fd, int bytes, char* buf){
+    return ring_write_at(fd, positions[fd], bytes, buf);
+}
+
+int ring_read_next(int fd, int bytes, char* buf){
+    energy_storage_begin();
+    drain();
+    read_done = 0;
+    queue_read(fd, positions[fd], bytes, buf);
+    int err = drain();
+    positions[fd] += read_done;
+    energy_storage_end(0, read_done);
+    return (err == -1) ? -1 : read_done;
+}
+
+int ring_flush(int fd){
+    energy_storage_begin();
+    int err = drain();
+    if(POSIX_SYNC != POSIX_SYNC_NEVER && fdatasync(fd) == -1){
+        err = -1;
+    }
+    energy_storage_end(0, 0);
+    return err;
+}
+
+int ring_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int err = 0;
+    int written = 0;
+    for(int i = 0; i < count; i++){
+        if(queue_write(fd, start_pos + written, vec[i].bytes, vec[i].buf) == -1){
+            err = -1;
+        }
+        written += vec[i].bytes;
+    }
+    energy_storage_end(written, 0);
+    return err;
+}
+
+int ring_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    energy_storage_begin();
+    int err = drain();
+    read_done = 0;
+    int at = start_pos;
+    for(int i = 0; i < count; i++){
+        if(queue_read(fd, at, vec[i].bytes, vec[i].buf) == -1){
+            err = -1;
+        }
+        at += vec[i].bytes;
+    }
+    if(drain() == -1){
+        err = -1;
+    }
+    positions[fd] = start_pos + read_done;
+    energy_storage_end(0, read_done);
+    return (err == -1) ? -1 : read_done;
+}
@@ -0,0 +1,46 @@
+/*
+ring.c is a batching backend for the host build. writes are queued and
+handed to the kernel RING_DEPTH at a time through io_uring, or through a
+pool of threads where io_uring isn't available. it is only compiled into
+the host build (see Makefile.host).
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_RING_H
+#define WATZBENCH_RING_H
+#include "posix.h"
+
+// Most operations in flight, RING_DEPTH is clamped to this
+#ifdef RING_CONF_MAX_DEPTH
+#define RING_MAX_DEPTH RING_CONF_MAX_DEPTH
+#else
+#define RING_MAX_DEPTH 256
+#endif
+
+// Threads of the fallback pool
+#ifdef RING_CONF_THREADS
+#define RING_THREADS RING_CONF_THREADS
+#else
+#define RING_THREADS 4
+#endif
+
+extern int RING_DEPTH;
+extern int RING_POOL;
+
+struct IOVec;
+
+char* ring_engine();
+int ring_static_ram();
+void ring_init();
+int ring_open_get_fd(char*);
+int ring_write_at(int, int, int, char*);
+int ring_read_at(int, int, int, char*);
+int ring_close_fd(int);
+int ring_append(int, int, char*);
+int ring_read_next(int, int, char*);
+int ring_flush(int);
+int ring_writev_at(int, int, struct IOVec*, int);
+int ring_readv_at(int, int, struct IOVec*, int);
+
+#endif //WATZBENCH_RING_H
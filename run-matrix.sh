@@ -0,0 +1,136 @@
+#!/bin/bash
+# run-matrix.sh runs a matrix of watzbench tests in parallel, one process
+# per point, each in its own directory with a fresh flash image.
+#
+# usage: ./run-matrix.sh [-j jobs] [-t seconds] [-b binary] [-o report] matrix
+#   -j  processes at once, the number of cores by default
+#   -t  timeout of a single point, 600 seconds by default
+#   -b  the watzbench binary, watzbench.native or else watzbench.host
+#   -o  the merged report, matrix-report.csv by default
+#
+# the matrix file names the axes, one per line, and every combination of
+# them is a point. blank lines and lines starting with # are ignored:
+#   tests: ThroughputSeqWrite ThroughputSeqRead
+#   apis: Coffee LogFS
+#   WRITE_BYTES: 256 1024
+#   BUFFER: 16 128
+#
+# a point sets its parameters and runs its test through the console, then
+# dumps the journal. the report has one line per point, keyed by the point
+# number, with the point, how it ended (ok, timeout or failed) and the
+# journal record of its test and api. a failed run leaves no record. the
+# full console output of every point is kept in the work directory, which
+# is printed at the end.
+
+jobs=$(nproc 2>/dev/null || echo 1)
+timeout=600
+binary=
+report=matrix-report.csv
+
+while getopts "j:t:b:o:" opt; do
+    case $opt in
+        j) jobs=$OPTARG ;;
+        t) timeout=$OPTARG ;;
+        b) binary=$OPTARG ;;
+        o) report=$OPTARG ;;
+        *) sed -n '5,9p' "$0" >&2; exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+matrix=$1
+if [ -z "$matrix" ] || [ ! -r "$matrix" ]; then
+    sed -n '5,9p' "$0" >&2
+    exit 2
+fi
+if [ -z "$binary" ]; then
+    for b in ./watzbench.native ./watzbench.host; do
+        if [ -x "$b" ]; then
+            binary=$b
+            break
+        fi
+    done
+fi
+if [ ! -x "$binary" ]; then
+    echo "no watzbench binary, build one or pass -b" >&2
+    exit 2
+fi
+binary=$(cd "$(dirname "$binary")" && pwd)/$(basename "$binary")
+
+work=$(mktemp -d "${TMPDIR:-/tmp}/watzbench-matrix.XXXXXX")
+
+# expand the axes into one line per point: test api PARAM=value...
+tests=
+apis=
+points=("")
+while IFS= read -r line; do
+    line=${line%%#*}
+    name=${line%%:*}
+    values=${line#*:}
+    name=$(echo $name)
+    [ -z "$name" ] && continue
+    case $name in
+        tests) tests=$values; continue ;;
+        apis) apis=$values; continue ;;
+    esac
+    next=()
+    for p in "${points[@]}"; do
+        for v in $values; do
+            next+=("$p $name=$v")
+        done
+    done
+    points=("${next[@]}")
+done < "$matrix"
+if [ -z "$tests" ] || [ -z "$apis" ]; then
+    echo "$matrix needs a tests: and an apis: line" >&2
+    exit 2
+fi
+id=0
+for t in $tests; do
+    for a in $apis; do
+        for p in "${points[@]}"; do
+            echo "$id $t $a$p"
+            id=$((id + 1))
+        done
+    done
+done > "$work/points"
+echo "$id points, $jobs at a time, work in $work" >&2
+
+# run_point runs one point in its own directory and leaves a result line
+run_point(){
+    local id=$1 test=$2 api=$3
+    shift 3
+    local dir=$work/$id
+    mkdir -p "$dir"
+    {
+        for p in "$@"; do
+            echo "set ${p%%=*} ${p#*=}"
+        done
+        echo "run $test $api"
+        echo "journal dump"
+        echo "quit"
+    } > "$dir/commands"
+    (cd "$dir" && timeout "$timeout" "$binary" . < commands > output 2>&1)
+    local code=$?
+    local status=ok
+    if [ $code -eq 124 ]; then
+        status=timeout
+    elif [ $code -ne 0 ] || grep -q "^ERROR" "$dir/output"; then
+        status=failed
+    fi
+    local record
+    record=$(grep "^journal,[0-9]*,$test,$api," "$dir/output" | tail -n 1 | cut -d, -f3-)
+    echo "$id,$test,$api,$*,$status,$record" > "$dir/result"
+    echo "point $id: $test $api $* $status" >&2
+}
+export -f run_point
+export work binary timeout
+
+xargs -P "$jobs" -L 1 bash -c 'run_point "$@"' _ < "$work/points"
+
+echo "point,test,api,params,status,journal_test,journal_api,ticks,write_bytes,buffer,stack,arena,uj,ops,written,read,journal_params" > "$report"
+for ((i = 0; i < id; i++)); do
+    cat "$work/$i/result" 2>/dev/null || echo "$i,,,,missing,"
+done >> "$report"
+failed=$(grep -vc ",ok," "$report")
+echo "report in $report, $((failed - 1)) of $id points did not finish ok, output in $work" >&2
+[ "$failed" -eq 1 ]
@@ -0,0 +1,194 @@
+/*
+scale.c is the scaling mode of the host build. it answers how storage
+throughput changes as more writers work at once.
+
+scale_run starts the given number of threads, each with its own copy of
+the test and the Posix backend. every thread prepares, then all of them
+run at the same time, then all of them tear down. the arena, the access
+patterns, the energy counters and the state the tests and the verifier
+keep between calls are per thread (see THREAD_LOCAL in common.h), so the
+copies don't see each other except through the files.
+
+with SCALE_SHARED 0 every thread has its own file namespace, names are
+prefixed with the thread number. with SCALE_SHARED 1 the threads use the
+same names, so a test that writes one file has all threads writing to
+that file.
+
+the threads only start preparing once all of them were created. if one
+can't be created, or one fails to prepare, none of them runs and the
+prepared ones tear down again.
+
+for every thread and for the whole run the api calls, bytes moved,
+throughput and the mean latency of an api call are printed. latency is
+the time spent in api calls divided by the calls. the aggregate
+throughput is over the wall time from the first run starting to the last
+one finishing.
+*/
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "scale.h"
+#include "api.h"
+
+struct Worker{
+    pthread_t thread;
+    int id;
+    char space[8];
+    struct Test test;
+    int err;
+    unsigned long start; // us, when the run started
+    unsigned long end;
+};
+
+static struct Worker workers[SCALE_MAX_THREADS];
+static pthread_barrier_t barrier;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t launch = PTHREAD_COND_INITIALIZER;
+static int launched; // 0 while threads are created, 1 to go, -1 to give up
+static int failed; // Threads whose prepare failed
+
+static unsigned long now_usec(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+static void* worker_thread(void* arg){
+    struct Worker* w = (struct Worker*)arg;
+    pthread_mutex_lock(&lock);
+    while(launched == 0){
+        pthread_cond_wait(&launch, &lock);
+    }
+    int go = (launched == 1);
+    pthread_mutex_unlock(&lock);
+    if(!go){
+        return NULL;
+    }
+    if(!SCALE_SHARED){
+        snprintf(w->space, sizeof(w->space), "t%d.", w->id);
+        posix_namespace(w->space);
+    }
+    arena_reset();
+    w->err = w->test.prepare(&w->test);
+    // like run_test, a prepare over the arena touched no files and isn't torn down
+    int touched = (arena_peak() <= ARENA_SIZE);
+    if(!touched){
+        w->err = -1;
+    }
+    if(w->err == -1){
+        pthread_mutex_lock(&lock);
+        failed++;
+        pthread_mutex_unlock(&lock);
+    }
+    pthread_barrier_wait(&barrier);
+    int run = (failed == 0);
+    energy_start();
+    w->start = now_usec();
+    if(run){
+        w->err = w->test.run(&w->test);
+    }
+    w->end = now_usec();
+    energy_stop(&w->test.energy);
+    pthread_barrier_wait(&barrier);
+    if(touched){
+        w->test.teardown(&w->test);
+    }
+    return NULL;
+}
+
+// bytes per second in KB/s, and the mean latency of a call in ns
+static void print_rate(unsigned long ops, unsigned long bytes, unsigned long usec, unsigned long long storage_ns){
+    unsigned long long kbs = (usec == 0) ? 0 : (bytes * 1000000ULL) / (usec * 1024ULL);
+    unsigned long long ops_s = (usec == 0) ? 0 : (ops * 1000000ULL) / usec;
+    unsigned long long lat = (ops == 0) ? 0 : storage_ns / ops;
+    printf("%lu ops, %lu bytes in %lu us, %llu KB/s, %llu ops/s, %llu ns/op\n", ops, bytes, usec, kbs, ops_s, lat);
+}
+
+/*
+scale_run runs threads copies of test at the same time
+*/
+void scale_run(struct Test* test, int threads){
+    if(threads < 1 || threads > SCALE_MAX_THREADS){
+        printf("threads has to be 1 to %d\n", SCALE_MAX_THREADS);
+        return;
+    }
+    printf("scale: %s on %s, %d threads, %s files\n",
+        test->name, Posix->name, threads, SCALE_SHARED ? "shared" : "separate");
+    Posix->init();
+    launched = 0;
+    failed = 0;
+    int created = 0;
+    while(created < threads){
+        struct Worker* w = &workers[created];
+        w->id = created;
+        w->test = *test;
+        w->test.api = Posix;
+        w->test.params = NULL;
+        w->err = 0;
+        if(pthread_create(&w->thread, NULL, worker_thread, w) != 0){
+            break;
+        }
+        created++;
+    }
+    if(created == threads){
+        pthread_barrier_init(&barrier, NULL, threads + 1);
+    }
+    pthread_mutex_lock(&lock);
+    launched = (created == threads) ? 1 : -1;
+    pthread_cond_broadcast(&launch);
+    pthread_mutex_unlock(&lock);
+    if(created < threads){
+        for(int i = 0; i < created; i++){
+            pthread_join(workers[i].thread, NULL);
+        }
+        printf("scale: only %d of %d threads could be created, nothing was run\n", created, threads);
+        return;
+    }
+    pthread_barrier_wait(&barrier);
+    pthread_barrier_wait(&barrier);
+    for(int i = 0; i < threads; i++){
+        pthread_join(workers[i].thread, NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    if(failed > 0){
+        printf("scale: %d of %d threads failed to prepare, nothing was run\n", failed, threads);
+        return;
+    }
+    unsigned long start = (unsigned long)-1;
+    unsigned long end = 0;
+    unsigned long ops = 0;
+    unsigned long bytes = 0;
+    unsigned long long storage = 0;
+    for(int i = 0; i < threads; i++){
+        struct Worker* w = &workers[i];
+        struct Energy* e = &w->test.energy;
+        unsigned long long ns = (e->storage_ticks * 1000000000ULL) / RTIMER_SECOND;
+        if(w->err == -1){
+            printf("scale: thread %d failed\n", i);
+            continue;
+        }
+        printf("scale: thread %d, ", i);
+        print_rate(e->ops, e->written + e->read, w->end - w->start, ns);
+        ops += e->ops;
+        bytes += e->written + e->read;
+        storage += ns;
+        start = (w->start < start) ? w->start : start;
+        end = (w->end > end) ? w->end : end;
+    }
+    printf("scale: %d threads, ", threads);
+    print_rate(ops, bytes, (end > start) ? end - start : 0, storage);
+}
+
+/*
+scale_sweep runs test on every thread count from 1 to the number of
+cores
+*/
+void scale_sweep(struct Test* test){
+    int cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cores > SCALE_MAX_THREADS){
+        cores = SCALE_MAX_THREADS;
+    }
+    for(int threads = 1; threads <= cores; threads++){
+        scale_run(test, threads);
+    }
+}
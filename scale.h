@@ -0,0 +1,25 @@
+/*
+scale.c runs several copies of a test at once, one per thread, against
+the Posix backend. it is only compiled into the host build (see
+Makefile.host).
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_SCALE_H
+#define WATZBENCH_SCALE_H
+#include "test.h"
+
+// Most threads a scaling run can use
+#ifdef SCALE_CONF_MAX_THREADS
+#define SCALE_MAX_THREADS SCALE_CONF_MAX_THREADS
+#else
+#define SCALE_MAX_THREADS 64
+#endif
+
+extern int SCALE_SHARED;
+
+void scale_run(struct Test*, int threads);
+void scale_sweep(struct Test*);
+
+#endif //WATZBENCH_SCALE_H
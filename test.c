@@ -8,6 +8,14 @@ test completion, the pointer will be removed.
 */
 
 #include "test.h"
+#include "job.h"
+#include "journal.h"
+#include "trace.h"
+#include "instrument.h"
+#include "compress.h"
+#include "verify.h"
+#include "archive.h"
+#include "database.h"
 
 /*
 new_test is a constructor for the test. the various components of the test 
@@ -25,8 +33,13 @@ struct Test* new_test(
     test_ptr->api = NULL;
     test_ptr->params = NULL;
     test_ptr->name = test_name;
+    test_ptr->id = NULL;
+    test_ptr->job = NULL;
     test_ptr->start_time = 0;
     test_ptr->completion_time = 0;
+    test_ptr->stack_peak = 0;
+    test_ptr->arena_peak = 0;
+    memset(&test_ptr->energy, 0, sizeof(test_ptr->energy));
     test_ptr->prepare = prepare_func;
     test_ptr->run = run_func;
     test_ptr->teardown = teardown_func;
@@ -34,67 +47,127 @@ struct Test* new_test(
 }
 
 /*
-free_test is a destructor for the Test struct
+free_test is a destructor for the Test struct. its params live in the
+arena, which is released by arena_reset.
 */
 void free_test(struct Test* test){
-    if(test->params != NULL){
-        free_test_params(test->params);
-        test->params = NULL;
-    }
     free(test);
 }
 
+/*
+new_test_params allocates TestParams from the arena, it returns NULL if
+the arena is too small for it. there is no destructor, teardown functions
+only have to drop their pointer, and the memory is released when the next
+test resets the arena.
+*/
 struct TestParams* new_test_params(){
-    void* t = malloc(sizeof(struct TestParams));
+    void* t = arena_alloc(sizeof(struct TestParams));
+    if(t == NULL){
+        return NULL;
+    }
     struct TestParams* test_params_ptr = (struct TestParams*)t;
     test_params_ptr->rands = NULL;
     test_params_ptr->filename = NULL;
+    test_params_ptr->names = NULL;
     test_params_ptr->buffer = NULL;
     test_params_ptr->count = 0;
     test_params_ptr->fd = -1;
     test_params_ptr->sizes = NULL;
     test_params_ptr->fds = NULL;
+    test_params_ptr->vecs = NULL;
+    test_params_ptr->ops = NULL;
+    test_params_ptr->hists = NULL;
     return test_params_ptr;
 }
 
 /*
-free_test is a destructor for the Test structextern struct Test* FileMetaDataCreate;
-extern struct Test* FileMetaDataDelete;
+name_files formats the names of files 0 to count - 1 into params->names,
+so tests don't call sprintf while they are timed
 */
-void free_test_params(struct TestParams* params){
-    if(params->buffer != NULL){
-        free(params->buffer);
-    }
-    if(params->fds != NULL){
-        free(params->fds);
+void name_files(struct TestParams* params, int count){
+    void* t = arena_alloc(count * MAX_FILENAME_SIZE);
+    params->names = (char*)t;
+    for(int i = 0; t != NULL && i < count; i++){
+        sprintf(FILE_NAME(params, i), "%d", i);
     }
-    if(params->rands != NULL){
-        free(params->rands);
-    }
-    free(params);
 }
 
 /*
-run_test actually executes the test.
+run_test actually executes the test. all test allocations come from the
+arena, which is reset before the test prepares. if prepare needed more
+than ARENA_SIZE the test isn't run. prepares check the arena before they
+touch the filesystem, so there is nothing to tear down then. if prepare
+or run fail the test is torn down and nothing is timed or journaled.
+
+the footprint of a test is the peak stack below run_test (see
+footprint.c) and the peak arena use from prepare to teardown. it is
+printed with the static ram of the backend before the timing. every
+completed run is also appended to the journal (see journal.c).
 */
 void run_test(struct API* api_ptr, struct Test* test){
+    if(!API_BOUND(api_ptr)){
+        log_error("this build is bound to another api (" API_DISPATCH ")");
+        return;
+    }
     test->api = api_ptr;
-    test->api->init();
+    API_CALL(test->api, init)();
+    arena_reset();
+    footprint_paint();
+    clock_time_t start = clock_time();
     int err = test->prepare(test);
-    check(err, "error in prepare function", TRUE);
+    test->prepare_time = clock_time() - start;
+    if(arena_peak() > ARENA_SIZE){
+        printf("arena peak: %d of %d bytes\n", arena_peak(), ARENA_SIZE);
+        log_error("test does not fit in the arena, not running it");
+        test->params = NULL;
+        test->api = NULL;
+        return;
+    }
+    if(err == -1){
+        log_error("error in prepare function, not running the test");
+        test->teardown(test);
+        test->api = NULL;
+        return;
+    }
     if (POWER_TESTS == 1){
-        powertrace_start(CLOCK_SECOND * 9999);
+        energy_start();
     }
+    instrument_reset();
+    compress_reset();
+    verify_reset();
     test->start_time = clock_time();
     err = test->run(test);
     test->completion_time = clock_time();
     if (POWER_TESTS == 1){
-        powertrace_stop();
-        powertrace_print("");
+        energy_stop(&test->energy);
+        energy_print(&test->energy);
     }
-    check(err, "error in test function", TRUE);
+    instrument_print();
+    compress_print();
+    verify_print();
+    if(err == -1){
+        log_error("error in test function, the test failed");
+        test->teardown(test);
+        test->api = NULL;
+        return;
+    }
+    start = clock_time();
     err = test->teardown(test);
+    test->teardown_time = clock_time() - start;
     check(err, "error in teardown function", TRUE);
+    test->stack_peak = footprint_stack_peak();
+    test->arena_peak = arena_peak();
+    printf("footprint: %s static %d, stack %d, arena %d of %d bytes\n",
+        test->api->name,
+        test->api->static_ram,
+        test->stack_peak,
+        test->arena_peak,
+        ARENA_SIZE);
+    printf("phases: prepare %u, run %u, teardown %u ticks\n",
+        (uint)test->prepare_time,
+        (uint)(test->completion_time - test->start_time),
+        (uint)test->teardown_time);
+    journal_append(test);
     test->api = NULL;
     printf("%u\n", ((uint)test->completion_time - (uint)test->start_time));
 }
@@ -109,569 +182,581 @@ The functions below define the various benchmarks WatzBench supports
 // Open Uncached File
 int verification_open_uncached_prepare(struct Test* test){
     test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
     test->params->count = FILES_TO_CREATE;
-    char filename[MAX_FILENAME_SIZE];
+    name_files(test->params, test->params->count);
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
+    }
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
+        API_CALL(test->api, create_file)(FILE_NAME(test->params, i));
     }
+    test->params->filename = FILE_NAME(test->params, random_rand() % test->params->count);
     return 0;
 }
 
 int verification_open_uncached_run(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    sprintf(filename, "%d", (random_rand() % test->params->count));
-    test->api->open_get_fd(filename);
+    API_CALL(test->api, open_get_fd)(test->params->filename);
     return 0;
 }
 
 int verification_open_uncached_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
+        API_CALL(test->api, delete_file)(FILE_NAME(test->params, i));
     }
-    free_test_params(test->params);
+    test->params = NULL;
     return 0;
 }
 
 // Open Cached File
 int verification_open_cached_prepare(struct Test* test){
     test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
     test->params->count = FILES_TO_CREATE;
-    char filename[MAX_FILENAME_SIZE];
+    name_files(test->params, test->params->count);
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
+    }
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
+        API_CALL(test->api, create_file)(FILE_NAME(test->params, i));
     }
-    sprintf(filename, "%d", (random_rand() % test->params->count));
-    test->params->filename = filename;
-    test->params->fd = test->api->open_get_fd(test->params->filename);
-    test->api->close_fd(test->params->fd);
+    test->params->filename = FILE_NAME(test->params, random_rand() % test->params->count);
+    test->params->fd = API_CALL(test->api, open_get_fd)(test->params->filename);
+    API_CALL(test->api, close_fd)(test->params->fd);
     return 0;
 }
 
 int verification_open_cached_run(struct Test* test){
-    test->api->open_get_fd(test->params->filename);
+    API_CALL(test->api, open_get_fd)(test->params->filename);
     return 0;
 }
 
 int verification_open_cached_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
+        API_CALL(test->api, delete_file)(FILE_NAME(test->params, i));
     }
-    free_test_params(test->params);
+    test->params = NULL;
     return 0;
 }
 
 // Initial File Modification
-int verification_initial_modify_prepare(struct Test* test){
-    test->params = new_test_params();
+// the files are written once, then the run modifies WATZ (file FILES_TO_CREATE)
+static const struct JobPhase verification_initial_modify_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = JOB_FILES},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ, .flags = JOB_REOPEN,
+        .files = JOB_FILES, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .first = JOB_FILES, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ, .flags = JOB_REOPEN,
+        .first = JOB_FILES, .files = 1, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .first = JOB_FILES, .files = 1},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_SEQ,
+        .first = JOB_FILES, .files = 1, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .first = JOB_FILES, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = JOB_FILES},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .first = JOB_FILES, .files = 1},
+};
+static const struct Job verification_initial_modify_job = JOB(verification_initial_modify_phases);
 
-    void* t = malloc(WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
-    }
+// Subsequent File Modification
+// same as the initial modification, but WATZ has been modified once already
+static const struct JobPhase verification_sub_modify_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = JOB_FILES},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ, .flags = JOB_REOPEN,
+        .files = JOB_FILES, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .first = JOB_FILES, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ, .flags = JOB_REOPEN,
+        .first = JOB_FILES, .files = 1, .count = 2, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .first = JOB_FILES, .files = 1},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_SEQ,
+        .first = JOB_FILES, .files = 1, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .first = JOB_FILES, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = JOB_FILES},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .first = JOB_FILES, .files = 1},
+};
+static const struct Job verification_sub_modify_job = JOB(verification_sub_modify_phases);
+
+
+/// MICROBENCHMARKS
+// FILE METADATA
+
+// CREATE FILE
+static const struct JobPhase file_metadata_create_phases[] = {
+    {.stage = JOB_RUN, .op = JOB_CREATE, .files = JOB_FILES},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = JOB_FILES},
+};
+static const struct Job file_metadata_create_job = JOB(file_metadata_create_phases);
 
+// DELETE FILES
+static const struct JobPhase file_metadata_delete_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = JOB_FILES},
+    {.stage = JOB_RUN, .op = JOB_DELETE, .files = JOB_FILES},
+};
+static const struct Job file_metadata_delete_job = JOB(file_metadata_delete_phases);
+
+// OPEN FILE
+static const struct JobPhase file_metadata_open_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = JOB_FILES},
+    {.stage = JOB_RUN, .op = JOB_OPEN, .files = JOB_FILES},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = JOB_FILES},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = JOB_FILES},
+};
+static const struct Job file_metadata_open_job = JOB(file_metadata_open_phases);
+
+// THROUGHPUT
+// all throughput tests move WRITE_BYTES in BUFFER sized calls FILES_TO_CREATE times
+
+// SEQ READS
+static const struct JobPhase throughput_seq_read_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ,
+        .files = 1, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_WRITE_BYTES},
+    {.stage = JOB_RUN, .op = JOB_READ, .pattern = JOB_SEQ,
+        .files = 1, .count = JOB_FILES, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job throughput_seq_read_job = JOB(throughput_seq_read_phases);
+
+// SEQ WRITE
+static const struct JobPhase throughput_seq_write_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_SEQ,
+        .files = 1, .count = JOB_FILES, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job throughput_seq_write_job = JOB(throughput_seq_write_phases);
+
+// RAND READ
+// the file is written in BUFFER sized calls, the offsets already take most of the arena
+static const struct JobPhase throughput_rand_read_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ,
+        .files = 1, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_RUN, .op = JOB_READ, .pattern = JOB_RANDOM,
+        .files = 1, .count = JOB_FILES, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job throughput_rand_read_job = JOB(throughput_rand_read_phases);
+
+// RAND WRITE
+static const struct JobPhase throughput_rand_write_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_RANDOM,
+        .files = 1, .count = JOB_FILES, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job throughput_rand_write_job = JOB(throughput_rand_write_phases);
+
+// STREAM READ
+// same as the sequential read, but only the first read of a pass is positioned
+static const struct JobPhase throughput_stream_read_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_WRITE, .pattern = JOB_SEQ,
+        .files = 1, .count = 1, .size = JOB_WRITE_BYTES, .chunk = JOB_WRITE_BYTES},
+    {.stage = JOB_RUN, .op = JOB_READ, .pattern = JOB_STREAM,
+        .files = 1, .count = JOB_FILES, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job throughput_stream_read_job = JOB(throughput_stream_read_phases);
+
+// STREAM WRITE
+// same as the sequential write, but only the first write of a pass is positioned
+static const struct JobPhase throughput_stream_write_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_STREAM,
+        .files = 1, .count = JOB_FILES, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job throughput_stream_write_job = JOB(throughput_stream_write_phases);
+
+// DURABILITY
+// a log that appends BUFFER sized records and flushes every FLUSH_INTERVAL
+// records, it grows by WRITE_BYTES per pass
+static const struct JobPhase durability_flush_phases[] = {
+    {.stage = JOB_PREPARE, .op = JOB_CREATE, .files = 1},
+    {.stage = JOB_PREPARE, .op = JOB_OPEN, .files = 1},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_NEXT, .flags = JOB_FLUSH,
+        .files = 1, .count = 10, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_CLOSE, .files = 1},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 1},
+};
+static const struct Job durability_flush_job = JOB(durability_flush_phases);
+
+// BATCHING
+// WRITE_BYTES split into RECORD_SIZE records, submitted BATCH_RECORDS at a time.
+// like a job, a run fails as soon as a call fails or a read comes back short
+int batch_prepare(struct Test* test){
+    test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
+    test->params->filename = "WATZ";
     test->params->count = FILES_TO_CREATE;
-    char filename[MAX_FILENAME_SIZE];
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
-        int fd = test->api->open_get_fd(test->params->filename);
-        int at = 0;
-        while(at < WRITE_BYTES){
-            if(WRITE_BYTES - at < BUFFER){
-                test->api->write_at(fd, 0, WRITE_BYTES - at, test->params->buffer);
-                at = WRITE_BYTES;
-            }else{
-                test->api->write_at(fd, 0, BUFFER, test->params->buffer);
-                at += BUFFER;
-            }
-        }
-        test->api->close_fd(fd);
+    void* t = arena_alloc(WRITE_BYTES);
+    test->params->buffer = (char*)t;
+    t = arena_alloc(sizeof(struct IOVec) * BATCH_RECORDS);
+    test->params->vecs = (struct IOVec*)t;
+    if(t == NULL || test->params->buffer == NULL){
+        return -1;
     }
-
-    test->api->create_file("WATZ");
-    test->params->fd = test->api->open_get_fd("WATZ");
-    int at = 0;
-    while(at < WRITE_BYTES){
-        if(WRITE_BYTES - at < BUFFER){
-            test->api->write_at(test->params->fd, 0, WRITE_BYTES - at, test->params->buffer);
-            at = WRITE_BYTES;
-        }else{
-            test->api->write_at(test->params->fd, 0, BUFFER, test->params->buffer);
-            at += BUFFER;
-        }
+    datagen_fill(test->params->buffer, WRITE_BYTES);
+    test->params->fd = -1;
+    if(API_CALL(test->api, create_file)(test->params->filename) == -1){
+        return -1;
     }
-    test->api->close_fd(test->params->fd);
-    test->params->fd = test->api->open_get_fd("WATZ");
-    return 0;
-}
-
-int verification_initial_modify_run(struct Test* test){
-    int at = 0;
-    while(at < WRITE_BYTES){
-        if(WRITE_BYTES - at < BUFFER){
-            test->api->write_at(test->params->fd, 0, WRITE_BYTES - at, test->params->buffer);
-            at = WRITE_BYTES;
-        }else{
-            test->api->write_at(test->params->fd, 0, BUFFER, test->params->buffer);
-            at += BUFFER;
-        }
+    test->params->fd = API_CALL(test->api, open_get_fd)(test->params->filename);
+    if(test->params->fd == -1){
+        return -1;
     }
-    return 0;
+    return API_CALL(test->api, write_at)(test->params->fd, 0, WRITE_BYTES, test->params->buffer);
 }
 
-int verification_initial_modify_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    test->api->close_fd(test->params->fd);
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
+/*
+batch_fill points up to BATCH_RECORDS iovecs at the records starting at
+at, and returns how many were used
+*/
+static int batch_fill(struct Test* test, int at){
+    int n = 0;
+    while(n < BATCH_RECORDS && at < WRITE_BYTES){
+        int bytes = (WRITE_BYTES - at < RECORD_SIZE) ? WRITE_BYTES - at : RECORD_SIZE;
+        test->params->vecs[n].buf = test->params->buffer + at;
+        test->params->vecs[n].bytes = bytes;
+        at += bytes;
+        n++;
     }
-    free_test_params(test->params);
-    test->api->delete_file("WATZ");
-    return 0;
+    return n;
 }
 
-// Subsequent File Modification
-int verification_sub_modify_prepare(struct Test* test){
-    test->params = new_test_params();
-
-    void* t = malloc(WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
-    }
-
-    test->params->count = FILES_TO_CREATE;
-    char filename[MAX_FILENAME_SIZE];
+int batch_write_run(struct Test* test){
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
-        int fd = test->api->open_get_fd(test->params->filename);
         int at = 0;
         while(at < WRITE_BYTES){
-            if(WRITE_BYTES - at < BUFFER){
-                test->api->write_at(fd, 0, WRITE_BYTES - at, test->params->buffer);
-                at = WRITE_BYTES;
+            if(BATCH_RECORDS <= 1){
+                int bytes = (WRITE_BYTES - at < RECORD_SIZE) ? WRITE_BYTES - at : RECORD_SIZE;
+                if(API_CALL(test->api, write_at)(test->params->fd, at, bytes, test->params->buffer + at) == -1){
+                    return -1;
+                }
+                at += bytes;
             }else{
-                test->api->write_at(fd, 0, BUFFER, test->params->buffer);
-                at += BUFFER;
+                int n = batch_fill(test, at);
+                if(API_CALL(test->api, writev_at)(test->params->fd, at, test->params->vecs, n) == -1){
+                    return -1;
+                }
+                at += (n - 1) * RECORD_SIZE + test->params->vecs[n - 1].bytes;
             }
         }
-        test->api->close_fd(fd);
-    }
-
-    test->api->create_file("WATZ");
-    test->params->fd = test->api->open_get_fd("WATZ");
-    int at = 0;
-    while(at < WRITE_BYTES){
-        if(WRITE_BYTES - at < BUFFER){
-            test->api->write_at(test->params->fd, 0, WRITE_BYTES - at, test->params->buffer);
-            at = WRITE_BYTES;
-        }else{
-            test->api->write_at(test->params->fd, 0, BUFFER, test->params->buffer);
-            at += BUFFER;
-        }
     }
-    test->api->close_fd(test->params->fd);
-    test->params->fd = test->api->open_get_fd("WATZ");
-    at = 0;
-    while(at < WRITE_BYTES){
-        if(WRITE_BYTES - at < BUFFER){
-            test->api->write_at(test->params->fd, WRITE_BYTES, WRITE_BYTES - at, test->params->buffer);
-            at = WRITE_BYTES;
-        }else{
-            test->api->write_at(test->params->fd, WRITE_BYTES, BUFFER, test->params->buffer);
-            at += BUFFER;
-        }
-    }
-    test->api->close_fd(test->params->fd);
-    test->params->fd = test->api->open_get_fd("WATZ");
     return 0;
 }
 
-int verification_sub_modify_run(struct Test* test){
-    int at = 0;
-    while(at < WRITE_BYTES){
-        if(WRITE_BYTES - at < BUFFER){
-            test->api->write_at(test->params->fd, 0, WRITE_BYTES - at, test->params->buffer);
-            at = WRITE_BYTES;
-        }else{
-            test->api->write_at(test->params->fd, 0, BUFFER, test->params->buffer);
-            at += BUFFER;
+int batch_read_run(struct Test* test){
+    for(int i = 0; i < test->params->count; i++){
+        int at = 0;
+        while(at < WRITE_BYTES){
+            if(BATCH_RECORDS <= 1){
+                int bytes = (WRITE_BYTES - at < RECORD_SIZE) ? WRITE_BYTES - at : RECORD_SIZE;
+                if(API_CALL(test->api, read_at)(test->params->fd, at, bytes, test->params->buffer + at) != bytes){
+                    return -1;
+                }
+                at += bytes;
+            }else{
+                int n = batch_fill(test, at);
+                int bytes = (n - 1) * RECORD_SIZE + test->params->vecs[n - 1].bytes;
+                if(API_CALL(test->api, readv_at)(test->params->fd, at, test->params->vecs, n) != bytes){
+                    return -1;
+                }
+                at += bytes;
+            }
         }
     }
     return 0;
 }
 
-int verification_sub_modify_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    test->api->close_fd(test->params->fd);
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
+int batch_cleanup(struct Test* test){
+    if(test->params->fd != -1){
+        API_CALL(test->api, close_fd)(test->params->fd);
     }
-    free_test_params(test->params);
-    test->api->delete_file("WATZ");
+    API_CALL(test->api, delete_file)(test->params->filename);
+    test->params = NULL;
     return 0;
 }
 
+// MIXED WORKLOAD
+// MIX_OPS RECORD_SIZE reads and writes over a MIX_WORKING_SET byte file,
+// MIX_WRITE_PERCENT of them writes, at record offsets following ACCESS_PATTERN
+#define MIX_READ 0
+#define MIX_WRITE 1
 
-/// MICROBENCHMARKS
-// FILE METADATA
-
-// CREATE FILE
-int file_metadata_create_test_prepare(struct Test* test){
+int mixed_prepare(struct Test* test){
     test->params = new_test_params();
-    test->params->count = FILES_TO_CREATE;
-    return 0;
-}
-
-int file_metadata_create_test_run(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
+    if(test->params == NULL){
+        return -1;
     }
-    return 0;
-}
-
-int file_metadata_create_test_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
+    test->params->filename = "WATZ";
+    test->params->count = MIX_OPS;
+    void* t = arena_alloc(RECORD_SIZE);
+    test->params->buffer = (char*)t;
+    t = arena_alloc(sizeof(int) * MIX_OPS);
+    test->params->rands = (int*)t;
+    t = arena_alloc(MIX_OPS);
+    test->params->ops = (unsigned char*)t;
+    t = arena_alloc(sizeof(struct Histogram) * 2);
+    test->params->hists = (struct Histogram*)t;
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
     }
+    datagen_fill(test->params->buffer, RECORD_SIZE);
 
-    free_test_params(test->params);
-    test->params = NULL;
-    return 0;
-}
+    // the offsets and the kind of every operation are decided up front
+    int records = MIX_WORKING_SET / RECORD_SIZE;
+    pattern_fill(test->params->rands, MIX_OPS, records);
+    pattern_seed(ACCESS_SEED + 1);
+    for(int i = 0; i < MIX_OPS; i++){
+        test->params->rands[i] *= RECORD_SIZE;
+        test->params->ops[i] = (pattern_rand() % 100 < MIX_WRITE_PERCENT) ? MIX_WRITE : MIX_READ;
+    }
+    histogram_reset(&test->params->hists[MIX_READ]);
+    histogram_reset(&test->params->hists[MIX_WRITE]);
 
-// DELETE FILES
-int file_metadata_delete_test_prepare(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    test->params = new_test_params();
-    test->params->count = FILES_TO_CREATE;
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
+    // reads should find data anywhere in the working set
+    API_CALL(test->api, create_file)(test->params->filename);
+    test->params->fd = API_CALL(test->api, open_get_fd)(test->params->filename);
+    for(int r = 0; r < records; r++){
+        API_CALL(test->api, write_at)(test->params->fd, r * RECORD_SIZE, RECORD_SIZE, test->params->buffer);
     }
     return 0;
 }
 
-int file_metadata_delete_test_run(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
+int mixed_run(struct Test* test){
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
+        rtimer_clock_t start = RTIMER_NOW();
+        if(test->params->ops[i] == MIX_WRITE){
+            API_CALL(test->api, write_at)(test->params->fd, test->params->rands[i], RECORD_SIZE, test->params->buffer);
+        }else{
+            API_CALL(test->api, read_at)(test->params->fd, test->params->rands[i], RECORD_SIZE, test->params->buffer);
+        }
+        histogram_add(&test->params->hists[test->params->ops[i]], (rtimer_clock_t)(RTIMER_NOW() - start));
     }
     return 0;
 }
 
-int file_metadata_delete_test_cleanup(struct Test* test){
-    free_test_params(test->params);
+int mixed_cleanup(struct Test* test){
+    histogram_print(&test->params->hists[MIX_READ], "read");
+    histogram_print(&test->params->hists[MIX_WRITE], "write");
+    API_CALL(test->api, close_fd)(test->params->fd);
+    API_CALL(test->api, delete_file)(test->params->filename);
     test->params = NULL;
     return 0;
 }
 
-// OPEN FILE
-int file_metadata_open_test_prepare(struct Test* test){
+// INGEST
+// a gateway logging INGEST_SENSORS sensors, one open file each. RECORD_SIZE
+// records are appended round robin until every file holds WRITE_BYTES
+int ingest_prepare(struct Test* test){
     test->params = new_test_params();
-    test->params->count = FILES_TO_CREATE;
-    char filename[MAX_FILENAME_SIZE];
-    void* t = malloc(sizeof(int) * FILES_TO_CREATE);
+    if(test->params == NULL){
+        return -1;
+    }
+    test->params->count = INGEST_SENSORS;
+    void* t = arena_alloc(sizeof(int) * INGEST_SENSORS);
     test->params->fds = (int*)t;
-    for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->api->create_file(filename);
+    t = arena_alloc(RECORD_SIZE);
+    test->params->buffer = (char*)t;
+    name_files(test->params, INGEST_SENSORS);
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
     }
-    return 0;
-}
-int file_metadata_open_test_run(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
+    datagen_fill(test->params->buffer, RECORD_SIZE);
     for(int i = 0; i < test->params->count; i++){
-        sprintf(filename, "%d", i);
-        test->params->fds[i] = test->api->open_get_fd(filename);
+        API_CALL(test->api, create_file)(FILE_NAME(test->params, i));
+        test->params->fds[i] = API_CALL(test->api, open_get_fd)(FILE_NAME(test->params, i));
     }
     return 0;
 }
 
-int file_metadata_open_test_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int i = 0; i < test->params->count; i++){
-        test->api->close_fd(test->params->fds[i]);
-        sprintf(filename, "%d", i);
-        test->api->delete_file(filename);
-    }
-    free_test_params(test->params);
-    return 0;
-}
-
-// THROUGHPUT
-// SEQ READS
-int throughput_seq_read_prepare(struct Test* test){
-    test->params = new_test_params();
-    test->params->filename = "WATZ";
-    test->params->count = FILES_TO_CREATE;
-    void* t = malloc(WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
+int ingest_run(struct Test* test){
+    for(int at = 0; at < WRITE_BYTES; at += RECORD_SIZE){
+        int bytes = (WRITE_BYTES - at < RECORD_SIZE) ? WRITE_BYTES - at : RECORD_SIZE;
+        for(int i = 0; i < test->params->count; i++){
+            API_CALL(test->api, append)(test->params->fds[i], bytes, test->params->buffer);
+        }
     }
-    test->api->create_file(test->params->filename);
-    test->params->fd = test->api->open_get_fd(test->params->filename);
-    test->api->write_at(test->params->fd, 0, WRITE_BYTES, test->params->buffer);
     return 0;
 }
 
-int throughput_seq_read_run(struct Test* test){
+int ingest_cleanup(struct Test* test){
     for(int i = 0; i < test->params->count; i++){
-        int at = 0;
-        while(at < WRITE_BYTES){
-            if((WRITE_BYTES - at) < BUFFER){
-                test->api->read_at(test->params->fd, at, WRITE_BYTES - at, test->params->buffer);
-                at = WRITE_BYTES;
-            }else{
-                test->api->read_at(test->params->fd, at, BUFFER, test->params->buffer);
-                at += BUFFER;
-            }
-        }
+        API_CALL(test->api, close_fd)(test->params->fds[i]);
+        API_CALL(test->api, delete_file)(FILE_NAME(test->params, i));
     }
-    return 0;
-}
-
-int throughput_seq_read_cleanup(struct Test* test){
-    test->api->close_fd(test->params->fd);
-    test->api->delete_file(test->params->filename);
-    free_test_params(test->params);
     test->params = NULL;
     return 0;
 }
 
-// SEQ WRITE
-int throughput_seq_write_prepare(struct Test* test){
-    test->params = new_test_params();
-    test->params->filename = "WATZ";
-    test->params->count = FILES_TO_CREATE;
-    void* t = malloc(WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
-    }
-    test->api->create_file(test->params->filename);
-    test->params->fd = test->api->open_get_fd(test->params->filename);
-    return 0;
-}
+// DIRECTORIES
+// DIR_FILES empty files in the root, every fourth named DIR_PREFIX<n> and the
+// rest dat<n>. names are made when needed, so DIR_FILES isn't bound by the arena.
+// DirList and DirFind list the root DIR_PASSES times, DirFind counting the
+// names with the prefix. DirDelete removes the prefixed files the way a log
+// upload would: list, keep up to DIR_BATCH names, delete them, list again
+#define DIR_PASSES 8
+#define DIR_BATCH 16
+#define DIR_NAME_SIZE 16
+#define DIR_PREFIX "log"
 
-int throughput_seq_write_run(struct Test* test){
-    for(int i = 0; i < test->params->count; i++){
-        int at = 0;
-        while(at < WRITE_BYTES){
-            if((WRITE_BYTES - at) < BUFFER){
-                test->api->write_at(test->params->fd, at, WRITE_BYTES - at, test->params->buffer);
-                at = WRITE_BYTES;
-            }else{
-                test->api->write_at(test->params->fd, at, BUFFER, test->params->buffer);
-                at += BUFFER;
-            }
-        }
-    }
-    return 0;
+static THREAD_LOCAL unsigned long dir_seen;
+static THREAD_LOCAL unsigned long dir_matched;
+static THREAD_LOCAL int dir_created;
+
+static void dir_name(char* name, int i){
+    sprintf(name, "%s%d", (i % 4 == 0) ? DIR_PREFIX : "dat", i);
 }
 
-int throughput_seq_write_cleanup(struct Test* test){
-    test->api->close_fd(test->params->fd);
-    test->api->delete_file(test->params->filename);
-    free_test_params(test->params);
-    return 0;
+static int dir_prefixed(char* name){
+    return strncmp(name, DIR_PREFIX, sizeof(DIR_PREFIX) - 1) == 0;
 }
 
-// RAND READ
-int throughput_rand_read_prepare(struct Test* test){
-    test->params = new_test_params();
-    test->params->filename = "WATZ";
-    test->params->count = FILES_TO_CREATE;
-    void* t = malloc(sizeof(char)*WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    test->api->create_file(test->params->filename);
-    test->params->fd = test->api->open_get_fd(test->params->filename);
-    return 0;
+static void dir_count(char* name, void* arg){
+    dir_seen++;
 }
-int throughput_rand_read_run(struct Test* test){
-    for(int i = 0; i < test->params->count; i++){
-        int at = 0;
-        while(at < WRITE_BYTES){
-            if((WRITE_BYTES - at) < BUFFER){
-                test->api->read_at(test->params->fd, random_rand() % (WRITE_BYTES - BUFFER), WRITE_BYTES - at, test->params->buffer);
-                at = WRITE_BYTES;
-            }else{
-                test->api->read_at(test->params->fd, random_rand() % (WRITE_BYTES - BUFFER), BUFFER, test->params->buffer);
-                at += BUFFER;
-            }
-        }
+
+static void dir_match(char* name, void* arg){
+    dir_seen++;
+    if(dir_prefixed(name)){
+        dir_matched++;
     }
-    return 0;
 }
 
-int throughput_rand_read_cleanup(struct Test* test){
-    test->api->close_fd(test->params->fd);
-    test->api->delete_file(test->params->filename);
-    free_test_params(test->params);
-    return 0;
+// dir_collect copies up to DIR_BATCH prefixed names into arg
+static void dir_collect(char* name, void* arg){
+    dir_seen++;
+    if(dir_prefixed(name) && dir_matched < DIR_BATCH){
+        char* slot = (char*)arg + dir_matched * DIR_NAME_SIZE;
+        strncpy(slot, name, DIR_NAME_SIZE - 1);
+        slot[DIR_NAME_SIZE - 1] = '\0';
+        dir_matched++;
+    }
 }
 
-// RAND WRITE
-int throughput_rand_write_prepare(struct Test* test){
+int dir_prepare(struct Test* test){
     test->params = new_test_params();
-    test->params->filename = "WATZ";
-    test->params->count = FILES_TO_CREATE;
-    void* t = malloc(sizeof(char)*BUFFER);
+    if(test->params == NULL){
+        return -1;
+    }
+    void* t = arena_alloc(DIR_BATCH * DIR_NAME_SIZE);
     test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
+    t = arena_alloc(sizeof(struct Histogram));
+    test->params->hists = (struct Histogram*)t;
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
     }
-    test->api->create_file(test->params->filename);
-    test->params->fd = test->api->open_get_fd(test->params->filename);
-    return 0;
-}
-int throughput_rand_write_run(struct Test* test){
-    for(int i = 0; i < test->params->count; i++){
-        int at = 0;
-        while(at < WRITE_BYTES){
-            if((WRITE_BYTES - at) < BUFFER){
-                test->api->write_at(test->params->fd, (random_rand() % (WRITE_BYTES - BUFFER)), WRITE_BYTES - at, test->params->buffer);
-                at = WRITE_BYTES;
-            }else{
-                test->api->write_at(test->params->fd, (random_rand() % (WRITE_BYTES - BUFFER)), BUFFER, test->params->buffer);
-                at += BUFFER;
-            }
+    histogram_reset(&test->params->hists[0]);
+    char name[DIR_NAME_SIZE];
+    dir_created = 0;
+    while(dir_created < DIR_FILES){
+        dir_name(name, dir_created);
+        if(API_CALL(test->api, create_file)(name) == -1){
+            break;
         }
+        dir_created++;
+    }
+    // fewer files would time a smaller directory than the one recorded
+    if(dir_created < DIR_FILES){
+        printf("dir: created %d of %d files\n", dir_created, DIR_FILES);
+        return -1;
     }
-    return 0;
-}
-int throughput_rand_write_cleanup(struct Test* test){
-    test->api->close_fd(test->params->fd);
-    test->api->delete_file(test->params->filename);
-    free_test_params(test->params);
     return 0;
 }
 
-/// MACROBENCHMARKS
-// Archival Storage
-int macrobenchmark_archival_prepare(struct Test* test){
-    test->params = new_test_params();
-    void* t = malloc(WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
-    }
-    return 0;
-}
-
-int macrobenchmark_archival_run(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int hour = 0; hour < 24; hour++){
-        sprintf(filename, "%d", hour);
-        test->api->create_file(filename);
-        int total_at = 0;
-        for(int min = 0; min < 60; min++){
-            int fd = test->api->open_get_fd(filename);
-            int at = 0;
-            while(at < WRITE_BYTES){
-                if(WRITE_BYTES - at < BUFFER){
-                    test->api->write_at(fd, total_at, WRITE_BYTES - at, test->params->buffer);
-                    total_at += (WRITE_BYTES - at);
-                    at = WRITE_BYTES;
-                }else{
-                    test->api->write_at(fd, total_at, BUFFER, test->params->buffer);
-                    at += BUFFER;
-                    total_at += BUFFER;
-                }
-            }
-            test->api->close_fd(fd);
+int dir_list_run(struct Test* test){
+    for(int pass = 0; pass < DIR_PASSES; pass++){
+        dir_seen = 0;
+        rtimer_clock_t start = RTIMER_NOW();
+        int count = API_CALL(test->api, list_dir)("/", dir_count, NULL);
+        histogram_add(&test->params->hists[0], (rtimer_clock_t)(RTIMER_NOW() - start));
+        if(count == -1 || count != dir_seen){
+            return -1;
         }
     }
     return 0;
 }
-int macrobenchmark_archival_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int hour = 0; hour < 24; hour++){
-        sprintf(filename, "%d", hour);
-        test->api->delete_file(filename);
+
+int dir_find_run(struct Test* test){
+    for(int pass = 0; pass < DIR_PASSES; pass++){
+        dir_seen = 0;
+        dir_matched = 0;
+        rtimer_clock_t start = RTIMER_NOW();
+        int count = API_CALL(test->api, list_dir)("/", dir_match, NULL);
+        histogram_add(&test->params->hists[0], (rtimer_clock_t)(RTIMER_NOW() - start));
+        if(count == -1){
+            return -1;
+        }
     }
-    free_test_params(test->params);
+    printf("dir: %lu of %lu files match " DIR_PREFIX "\n", dir_matched, dir_seen);
     return 0;
 }
 
-// Archival Storage And Query
-int macrobenchmark_archival_query_prepare(struct Test* test){
-    test->params = new_test_params();
-    void* t = malloc(WRITE_BYTES);
-    test->params->buffer = (char*)t;
-    for(int i = 0; i < WRITE_BYTES; i++){
-        test->params->buffer[i] = 'a';
-    }
-    return 0;
-}
-
-int macrobenchmark_archival_query_run(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int hour = 0; hour < 24; hour++){
-        sprintf(filename, "%d", hour);
-        test->api->create_file(filename);
-        int total_at = 0;
-        for(int min = 0; min < 60; min++){
-            int fd = test->api->open_get_fd(filename);
-            int at = 0;
-            while(at < WRITE_BYTES){
-                if(WRITE_BYTES - at < BUFFER){
-                    test->api->write_at(fd, total_at, WRITE_BYTES - at, test->params->buffer);
-                    total_at += (WRITE_BYTES - at);
-                    at = WRITE_BYTES;
-                }else{
-                    test->api->write_at(fd, total_at, BUFFER, test->params->buffer);
-                    at += BUFFER;
-                    total_at += BUFFER;
-                }
-            }
-            test->api->close_fd(fd);
+// each sample of the histogram is one listing with the deletes after it
+int dir_delete_run(struct Test* test){
+    unsigned long deleted = 0;
+    do{
+        dir_seen = 0;
+        dir_matched = 0;
+        rtimer_clock_t start = RTIMER_NOW();
+        if(API_CALL(test->api, list_dir)("/", dir_collect, test->params->buffer) == -1){
+            return -1;
         }
-        if(hour % 4 == 0){
-            int fd = test->api->open_get_fd(filename);
-            int at = 0;
-            for(int j =0;j<4;j++){
-                while(at < WRITE_BYTES){
-                    if(WRITE_BYTES - at < BUFFER){
-                        test->api->read_at(fd, 0, WRITE_BYTES - at, test->params->buffer);
-                        at = WRITE_BYTES;
-                    }else{
-                        test->api->read_at(fd, 0, BUFFER, test->params->buffer);
-                        at += BUFFER;
-                    }
-                }
+        for(int i = 0; i < dir_matched; i++){
+            if(API_CALL(test->api, delete_file)(test->params->buffer + i * DIR_NAME_SIZE) == -1){
+                return -1;
             }
         }
-    }
+        histogram_add(&test->params->hists[0], (rtimer_clock_t)(RTIMER_NOW() - start));
+        deleted += dir_matched;
+    }while(dir_matched > 0);
+    printf("dir: deleted %lu files\n", deleted);
     return 0;
 }
 
-int macrobenchmark_archival_query_cleanup(struct Test* test){
-    char filename[MAX_FILENAME_SIZE];
-    for(int mon = 0; mon < 12; mon++){
-        sprintf(filename, "%d", mon);
-        test->api->delete_file(filename);
+int dir_cleanup(struct Test* test){
+    histogram_print(&test->params->hists[0], "list");
+    char name[DIR_NAME_SIZE];
+    for(int i = 0; i < DIR_FILES; i++){
+        dir_name(name, i);
+        API_CALL(test->api, delete_file)(name);
     }
-    free_test_params(test->params);
+    test->params = NULL;
     return 0;
 }
 
+/// MACROBENCHMARKS
+// Archival Storage
+// a file per hour, and each minute WRITE_BYTES are appended to it. the day is
+// 1440 * WRITE_BYTES, 1.4M at the default 1024, which is more than the 960k
+// LogFS and Coffee use on the sky. run it there with WRITE_BYTES 512 or less
+static const struct JobPhase macrobenchmark_archival_phases[] = {
+    {.stage = JOB_RUN, .op = JOB_CREATE, .files = 24},
+    {.stage = JOB_RUN, .op = JOB_WRITE, .pattern = JOB_TAIL, .flags = JOB_REOPEN,
+        .files = 24, .count = 60, .size = JOB_WRITE_BYTES, .chunk = JOB_BUFFER},
+    {.stage = JOB_TEARDOWN, .op = JOB_DELETE, .files = 24},
+};
+static const struct Job macrobenchmark_archival_job = JOB(macrobenchmark_archival_phases);
+
 // Signal Processing
 int macrobenchmark_signal_prepare(struct Test* test){
     return 0;
@@ -735,9 +820,26 @@ struct Test* FileMetaDataOpen;
 struct Test* ThroughputSeqWrite;
 struct Test* ThroughputRandRead;
 struct Test* ThroughputRandWrite;
+struct Test* ThroughputStreamRead;
+struct Test* ThroughputStreamWrite;
+struct Test* DurabilityFlush;
+struct Test* BatchRecordWrite;
+struct Test* BatchRecordRead;
+struct Test* MixedWorkload;
+struct Test* SensorIngest;
+struct Test* TraceReplay;
+struct Test* DirList;
+struct Test* DirFind;
+struct Test* DirDelete;
 // Macrobenchmarks
 struct Test* ArchivalStorage;
-struct Test* ArchivalStorageAndQuery;
+struct Test* ArchiveQuery;
+#ifdef WATZBENCH_ANTELOPE
+struct Test* DbInsert;
+struct Test* DbSelect;
+struct Test* DbRange;
+struct Test* DbDelete;
+#endif
 struct Test* SignalProcessing;
 struct Test* NetworkRouting;
 struct Test* DebuggingLogs;
@@ -762,72 +864,138 @@ void init_test(){
         verification_open_cached_run,
         verification_open_cached_cleanup
     );
-    VerifyModifyInitial = new_test(
+    VerifyModifyInitial= new_job_test(
         "Verification Test - Initial Modify",
-        verification_initial_modify_prepare,
-        verification_initial_modify_run,
-        verification_initial_modify_cleanup
+        &verification_initial_modify_job
     );
-    VerifyModifySub = new_test(
+    VerifyModifySub= new_job_test(
         "Verification Test - Subsequent Modify",
-        verification_sub_modify_prepare,
-        verification_sub_modify_run,
-        verification_sub_modify_cleanup
+        &verification_sub_modify_job
     );
-    FileMetaDataCreate= new_test(
+    FileMetaDataCreate= new_job_test(
         "Metadata Test - Create Files",
-        file_metadata_create_test_prepare,
-        file_metadata_create_test_run,
-        file_metadata_create_test_cleanup
+        &file_metadata_create_job
     );
-    FileMetaDataDelete= new_test(
+    FileMetaDataDelete= new_job_test(
         "Metadata Test - Delete Files",
-        file_metadata_delete_test_prepare,
-        file_metadata_delete_test_run,
-        file_metadata_delete_test_cleanup
+        &file_metadata_delete_job
     );
-    FileMetaDataOpen= new_test(
+    FileMetaDataOpen= new_job_test(
         "Metadata Test - Open Files",
-        file_metadata_open_test_prepare,
-        file_metadata_open_test_run,
-        file_metadata_open_test_cleanup
+        &file_metadata_open_job
     );
-    ThroughputSeqRead= new_test(
+    ThroughputSeqRead= new_job_test(
         "Throughput Test - Sequential Read",
-        throughput_seq_read_prepare,
-        throughput_seq_read_run,
-        throughput_seq_read_cleanup
+        &throughput_seq_read_job
     );
-    ThroughputSeqWrite= new_test(
+    ThroughputSeqWrite= new_job_test(
         "Throughput Test - Sequential Write",
-        throughput_seq_write_prepare,
-        throughput_seq_write_run,
-        throughput_seq_write_cleanup
+        &throughput_seq_write_job
     );
-    ThroughputRandRead= new_test(
+    ThroughputRandRead= new_job_test(
         "Throughput Test - Random Read",
-        throughput_rand_read_prepare,
-        throughput_rand_read_run,
-        throughput_rand_read_cleanup
+        &throughput_rand_read_job
     );
-    ThroughputRandWrite= new_test(
+    ThroughputRandWrite= new_job_test(
         "Throughput Test - Random Write",
-        throughput_rand_write_prepare,
-        throughput_rand_write_run,
-        throughput_rand_write_cleanup
+        &throughput_rand_write_job
+    );
+    ThroughputStreamRead= new_job_test(
+        "Throughput Test - Stream Read",
+        &throughput_stream_read_job
     );
-    ArchivalStorage= new_test(
+    ThroughputStreamWrite= new_job_test(
+        "Throughput Test - Stream Write",
+        &throughput_stream_write_job
+    );
+    DurabilityFlush= new_job_test(
+        "Durability Test - Flush Interval",
+        &durability_flush_job
+    );
+    BatchRecordWrite= new_test(
+        "Batch Test - Record Write",
+        batch_prepare,
+        batch_write_run,
+        batch_cleanup
+    );
+    BatchRecordRead= new_test(
+        "Batch Test - Record Read",
+        batch_prepare,
+        batch_read_run,
+        batch_cleanup
+    );
+    MixedWorkload= new_test(
+        "Mixed Test - Read/Write Mix",
+        mixed_prepare,
+        mixed_run,
+        mixed_cleanup
+    );
+    SensorIngest= new_test(
+        "Ingest Test - Sensor Records",
+        ingest_prepare,
+        ingest_run,
+        ingest_cleanup
+    );
+    TraceReplay= new_test(
+        "Trace Test - Replay",
+        trace_prepare,
+        trace_run,
+        trace_teardown
+    );
+    DirList= new_test(
+        "Directory Test - List",
+        dir_prepare,
+        dir_list_run,
+        dir_cleanup
+    );
+    DirFind= new_test(
+        "Directory Test - Find By Prefix",
+        dir_prepare,
+        dir_find_run,
+        dir_cleanup
+    );
+    DirDelete= new_test(
+        "Directory Test - Delete By Listing",
+        dir_prepare,
+        dir_delete_run,
+        dir_cleanup
+    );
+    ArchivalStorage= new_job_test(
         "Macrobench - Archival Storage",
-        macrobenchmark_archival_prepare,
-        macrobenchmark_archival_run,
-        macrobenchmark_archival_cleanup
+        &macrobenchmark_archival_job
+    );
+    ArchiveQuery= new_test(
+        "Macrobench - Archive Time Queries",
+        archive_prepare,
+        archive_run,
+        archive_teardown
+    );
+#ifdef WATZBENCH_ANTELOPE
+    DbInsert= new_test(
+        "Database Test - Insert",
+        database_insert_prepare,
+        database_insert_run,
+        database_teardown
+    );
+    DbSelect= new_test(
+        "Database Test - Indexed Select",
+        database_filled_prepare,
+        database_select_run,
+        database_teardown
+    );
+    DbRange= new_test(
+        "Database Test - Range Select",
+        database_filled_prepare,
+        database_range_run,
+        database_teardown
     );
-    ArchivalStorageAndQuery= new_test(
-        "Macrobench - Archival Storage And Query",
-        macrobenchmark_archival_query_prepare,
-        macrobenchmark_archival_query_run,
-        macrobenchmark_archival_query_cleanup
+    DbDelete= new_test(
+        "Database Test - Delete",
+        database_filled_prepare,
+        database_delete_run,
+        database_teardown
     );
+#endif
     SignalProcessing= new_test(
         "Macrobench - Signal Processing",
         macrobenchmark_signal_prepare,
@@ -870,8 +1038,25 @@ void cleanup_test(){
     free_test(ThroughputSeqWrite);
     free_test(ThroughputRandRead);
     free_test(ThroughputRandWrite);
+    free_test(ThroughputStreamRead);
+    free_test(ThroughputStreamWrite);
+    free_test(DurabilityFlush);
+    free_test(BatchRecordWrite);
+    free_test(BatchRecordRead);
+    free_test(MixedWorkload);
+    free_test(SensorIngest);
+    free_test(TraceReplay);
+    free_test(DirList);
+    free_test(DirFind);
+    free_test(DirDelete);
     free_test(ArchivalStorage);
-    free_test(ArchivalStorageAndQuery);
+    free_test(ArchiveQuery);
+#ifdef WATZBENCH_ANTELOPE
+    free_test(DbInsert);
+    free_test(DbSelect);
+    free_test(DbRange);
+    free_test(DbDelete);
+#endif
     free_test(SignalProcessing);
     free_test(NetworkRouting);
     free_test(DebuggingLogs);
@@ -8,9 +8,13 @@ additional information is available in the c file.
 #define WATZBENCH_TEST_H
 #include "api.h"
 #include "common.h"
+#include "pattern.h"
+#include "datagen.h"
+#include "histogram.h"
+#include "arena.h"
+#include "footprint.h"
 #include "contiki.h"
 #include "lib/random.h"
-#include "powertrace.h"
 
 // Verification
 extern struct Test* VerifyOpenUncached;
@@ -26,10 +30,27 @@ extern struct Test* ThroughputSeqRead;
 extern struct Test* ThroughputSeqWrite;
 extern struct Test* ThroughputRandRead;
 extern struct Test* ThroughputRandWrite;
+extern struct Test* ThroughputStreamRead;
+extern struct Test* ThroughputStreamWrite;
+extern struct Test* DurabilityFlush;
+extern struct Test* BatchRecordWrite;
+extern struct Test* BatchRecordRead;
+extern struct Test* MixedWorkload;
+extern struct Test* SensorIngest;
+extern struct Test* TraceReplay;
+extern struct Test* DirList;
+extern struct Test* DirFind;
+extern struct Test* DirDelete;
 
 // Macrobenchmarks
 extern struct Test* ArchivalStorage;
-extern struct Test* ArchivalStorageAndQuery;
+extern struct Test* ArchiveQuery;
+#ifdef WATZBENCH_ANTELOPE
+extern struct Test* DbInsert;
+extern struct Test* DbSelect;
+extern struct Test* DbRange;
+extern struct Test* DbDelete;
+#endif
 extern struct Test* SignalProcessing;
 extern struct Test* NetworkRouting;
 extern struct Test* DebuggingLogs;
@@ -39,6 +60,14 @@ extern const int FILES_TO_CREATE;
 extern const int MAX_FILENAME_SIZE;
 extern int WRITE_BYTES;
 extern int BUFFER;
+extern int FLUSH_INTERVAL;
+extern int RECORD_SIZE;
+extern int BATCH_RECORDS;
+extern int MIX_WRITE_PERCENT;
+extern int MIX_WORKING_SET;
+extern int MIX_OPS;
+extern int INGEST_SENSORS;
+extern int DIR_FILES;
 extern const int POWER_TESTS;
 
 /*
@@ -55,13 +84,23 @@ tests have 3 major parts--
 
 the TestParams structure can be modified to allow paramaters to be passed 
 to the tests.
+
+most tests don't need their own functions, they are described by a job
+(see job.c) and created with new_job_test.
 */
 struct Test{
     struct API* api;
     struct TestParams* params;
+    const struct Job* job;
     char* name;
+    const char* id; // the short name the console runs it by, NULL until the console starts
     clock_time_t start_time;
     clock_time_t completion_time;
+    clock_time_t prepare_time; // how long prepare took
+    clock_time_t teardown_time;
+    int stack_peak;
+    int arena_peak;
+    struct Energy energy;
     int(*prepare)(struct Test* test);
     int(*run)(struct Test* test);
     int(*teardown)(struct Test* test);
@@ -78,15 +117,22 @@ void run_test(struct API*, struct Test*);
 
 struct TestParams{
     char* filename;
+    char* names;
     char* buffer;
     int count;
     int fd;
     int* fds;
     int* sizes;
     int* rands;
+    struct IOVec* vecs;
+    unsigned char* ops;
+    struct Histogram* hists;
 };
 struct TestParams* new_test_params();
-void free_test_params(struct TestParams* test_params);
+
+// The name of file i, after name_files has been called
+#define FILE_NAME(params, i) (&(params)->names[(i) * MAX_FILENAME_SIZE])
+void name_files(struct TestParams*, int count);
 
 void init_test();
 void cleanup_test();
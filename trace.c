@@ -0,0 +1,560 @@
+/*
+trace.c captures the calls a workload makes to a backend and replays them
+against another one.
+
+Traced is a decorator api. trace_attach points it at a real backend, and
+every call made to Traced is passed on to that backend and recorded. the
+firmware in the field can do the same with its own backend to capture
+its workload. the console dumps a trace as "trace load" lines, so a
+captured dump can be fed back to any watzbench console and replayed there.
+
+a trace is a sequence of records, one per call, kept in a TRACE_SIZE ram
+buffer. numbers are unsigned varints (7 bits per byte, low bits first,
+the top bit set on every byte but the last) and fds are stored plus one
+so -1 fits. every record is:
+  op, delta
+followed by, depending on op:
+  create/delete file/dir:   name
+  list_dir:                 name
+  open:                     name, fd
+  write_at/read_at:         fd, pos, bytes
+  append/read_next:         fd, bytes
+  close/flush:              fd
+  writev_at/readv_at:       fd, pos, count, count lengths
+delta is the clock ticks since the call before (since trace_clear for
+the first), a name is a length byte and that many characters. the data
+itself isn't recorded, a replay writes DATA_KIND data. when the buffer is full
+recording stops, so a trace is always a whole prefix of the workload.
+
+a replay maps the fds of the trace to the fds the replaying backend hands
+out, through the open records. the TraceReplay test replays at full
+speed. trace_replay_process keeps the original timing: each call is made
+when its delta says, counted from the start of the replay, unless the
+backend is already behind.
+*/
+#include "trace.h"
+#include "test.h"
+
+struct API* Traced; // Pointer to the Traced API
+
+static unsigned char trace[TRACE_SIZE];
+static int used;
+static int calls;
+static unsigned char full;
+static clock_time_t last;
+static struct API* target;
+
+// the record being built, it goes into the trace only if all of it fits
+static unsigned char record[4 * 5 + TRACE_MAX_VECS * 5 + TRACE_NAME_SIZE];
+static int record_len;
+
+// recorded fd to the fd of the replaying backend
+static THREAD_LOCAL struct{
+    int recorded;
+    int actual;
+} fds[TRACE_MAX_FDS];
+static THREAD_LOCAL int replayed;
+static THREAD_LOCAL int failed;
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Recording
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static void put(unsigned long value){
+    while(value >= 0x80){
+        record[record_len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    record[record_len++] = value;
+}
+
+static void put_name(char* name){
+    int len = strlen(name);
+    if(len > TRACE_NAME_SIZE - 1){
+        len = TRACE_NAME_SIZE - 1;
+    }
+    record[record_len++] = len;
+    memcpy(&record[record_len], name, len);
+    record_len += len;
+}
+
+static void begin(unsigned char op){
+    clock_time_t now = clock_time();
+    record_len = 0;
+    record[record_len++] = op;
+    put((clock_time_t)(now - last));
+    last = now;
+}
+
+static void end(){
+    if(full){
+        return;
+    }
+    if(used + record_len > TRACE_SIZE){
+        full = 1;
+        log_error("trace is full, recording stopped");
+        return;
+    }
+    memcpy(&trace[used], record, record_len);
+    used += record_len;
+    calls++;
+}
+
+/*
+trace_attach makes Traced pass its calls on to api
+*/
+void trace_attach(struct API* api){
+    target = api;
+}
+
+void trace_clear(){
+    used = 0;
+    calls = 0;
+    full = 0;
+    last = clock_time();
+}
+
+/*
+trace_dump prints the trace as console commands that load it again
+*/
+void trace_dump(){
+    printf("trace: %d calls, %d of %d bytes%s\n", calls, used, TRACE_SIZE, full ? ", full" : "");
+    printf("trace clear\n");
+    for(int at = 0; at < used; at += 32){
+        printf("trace load ");
+        for(int i = at; i < used && i < at + 32; i++){
+            printf("%02x", trace[i]);
+        }
+        printf("\n");
+    }
+}
+
+static int hex(char c){
+    if(c >= '0' && c <= '9'){
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'f'){
+        return c - 'a' + 10;
+    }
+    if(c >= 'A' && c <= 'F'){
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/*
+trace_load appends the bytes given in hex to the trace, it returns -1 if
+they aren't hex or don't fit
+*/
+int trace_load(char* text){
+    int len = strlen(text);
+    if(len % 2 != 0 || used + len / 2 > TRACE_SIZE){
+        return -1;
+    }
+    for(int i = 0; i < len; i += 2){
+        if(hex(text[i]) == -1 || hex(text[i + 1]) == -1){
+            return -1;
+        }
+    }
+    for(int i = 0; i < len; i += 2){
+        trace[used++] = hex(text[i]) * 16 + hex(text[i + 1]);
+    }
+    return 0;
+}
+
+// the trace, the record being built and the fd map
+int trace_static_ram(){
+    return sizeof(trace) + sizeof(record) + sizeof(fds);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Traced Functions
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+void traced_init(){
+    target->init();
+}
+
+static int traced_name(unsigned char op, int (*fn)(char*), char* name){
+    begin(op);
+    put_name(name);
+    end();
+    return fn(name);
+}
+
+int traced_create_file(char* name){
+    return traced_name(TRACE_CREATE_FILE, target->create_file, name);
+}
+
+int traced_delete_file(char* name){
+    return traced_name(TRACE_DELETE_FILE, target->delete_file, name);
+}
+
+int traced_create_dir(char* name){
+    return traced_name(TRACE_CREATE_DIR, target->create_dir, name);
+}
+
+int traced_delete_dir(char* name){
+    return traced_name(TRACE_DELETE_DIR, target->delete_dir, name);
+}
+
+// the fd is only known after the call, the delta is taken before it
+int traced_open_get_fd(char* name){
+    begin(TRACE_OPEN);
+    int fd = target->open_get_fd(name);
+    put_name(name);
+    put(fd + 1);
+    end();
+    return fd;
+}
+
+int traced_write_at(int fd, int start_pos, int bytes, char* buf){
+    begin(TRACE_WRITE_AT);
+    put(fd + 1);
+    put(start_pos);
+    put(bytes);
+    end();
+    return target->write_at(fd, start_pos, bytes, buf);
+}
+
+int traced_read_at(int fd, int start_pos, int bytes, char* buf){
+    begin(TRACE_READ_AT);
+    put(fd + 1);
+    put(start_pos);
+    put(bytes);
+    end();
+    return target->read_at(fd, start_pos, bytes, buf);
+}
+
+int traced_close_fd(int fd){
+    begin(TRACE_CLOSE);
+    put(fd + 1);
+    end();
+    return target->close_fd(fd);
+}
+
+int traced_append(int fd, int bytes, char* buf){
+    begin(TRACE_APPEND);
+    put(fd + 1);
+    put(bytes);
+    end();
+    return target->append(fd, bytes, buf);
+}
+
+int traced_read_next(int fd, int bytes, char* buf){
+    begin(TRACE_READ_NEXT);
+    put(fd + 1);
+    put(bytes);
+    end();
+    return target->read_next(fd, bytes, buf);
+}
+
+int traced_flush(int fd){
+    begin(TRACE_FLUSH);
+    put(fd + 1);
+    end();
+    return target->flush(fd);
+}
+
+// a vectored call with more than TRACE_MAX_VECS buffers is recorded as single calls
+static void traced_vec(unsigned char op, unsigned char single, int fd, int start_pos, struct IOVec* vec, int count){
+    if(count > TRACE_MAX_VECS){
+        for(int i = 0; i < count; i++){
+            begin(single);
+            put(fd + 1);
+            put(start_pos);
+            put(vec[i].bytes);
+            end();
+            start_pos += vec[i].bytes;
+        }
+        return;
+    }
+    begin(op);
+    put(fd + 1);
+    put(start_pos);
+    put(count);
+    for(int i = 0; i < count; i++){
+        put(vec[i].bytes);
+    }
+    end();
+}
+
+int traced_writev_at(int fd, int start_pos, struct IOVec* vec, int count){
+    traced_vec(TRACE_WRITEV_AT, TRACE_WRITE_AT, fd, start_pos, vec, count);
+    return target->writev_at(fd, start_pos, vec, count);
+}
+
+int traced_readv_at(int fd, int start_pos, struct IOVec* vec, int count){
+    traced_vec(TRACE_READV_AT, TRACE_READ_AT, fd, start_pos, vec, count);
+    return target->readv_at(fd, start_pos, vec, count);
+}
+
+int traced_list_dir(char* name, void (*visit)(char*, void*), void* arg){
+    begin(TRACE_LIST_DIR);
+    put_name(name);
+    end();
+    return target->list_dir(name, visit, arg);
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+Replay
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+static int get(int* at, unsigned long* value){
+    int shift = 0;
+    *value = 0;
+    while(*at < used){
+        unsigned char b = trace[(*at)++];
+        *value |= (unsigned long)(b & 0x7F) << shift;
+        if(!(b & 0x80)){
+            return 0;
+        }
+        shift += 7;
+    }
+    return -1;
+}
+
+static int get_int(int* at, int* value){
+    unsigned long v;
+    int err = get(at, &v);
+    *value = v;
+    return err;
+}
+
+static int get_name(int* at, char* name){
+    if(*at >= used){
+        return -1;
+    }
+    int len = trace[(*at)++];
+    if(len > TRACE_NAME_SIZE - 1 || *at + len > used){
+        return -1;
+    }
+    memcpy(name, &trace[*at], len);
+    name[len] = '\0';
+    *at += len;
+    return 0;
+}
+
+/*
+trace_next decodes the record at at into call, it returns where the next
+record starts, or -1 at the end of the trace
+*/
+static int trace_next(int at, struct TraceCall* call){
+    if(at >= used){
+        return -1;
+    }
+    call->op = trace[at++];
+    int err = get(&at, &call->delta);
+    call->fd = 0;
+    call->bytes = 0;
+    call->count = 0;
+    switch(call->op){
+        case TRACE_CREATE_FILE:
+        case TRACE_DELETE_FILE:
+        case TRACE_CREATE_DIR:
+        case TRACE_DELETE_DIR:
+        case TRACE_LIST_DIR:
+            err |= get_name(&at, call->name);
+            break;
+        case TRACE_OPEN:
+            err |= get_name(&at, call->name);
+            err |= get_int(&at, &call->fd);
+            break;
+        case TRACE_WRITE_AT:
+        case TRACE_READ_AT:
+            err |= get_int(&at, &call->fd);
+            err |= get_int(&at, &call->pos);
+            err |= get_int(&at, &call->bytes);
+            break;
+        case TRACE_APPEND:
+        case TRACE_READ_NEXT:
+            err |= get_int(&at, &call->fd);
+            err |= get_int(&at, &call->bytes);
+            break;
+        case TRACE_CLOSE:
+        case TRACE_FLUSH:
+            err |= get_int(&at, &call->fd);
+            break;
+        case TRACE_WRITEV_AT:
+        case TRACE_READV_AT:
+            err |= get_int(&at, &call->fd);
+            err |= get_int(&at, &call->pos);
+            err |= get_int(&at, &call->count);
+            if(call->count > TRACE_MAX_VECS){
+                return -1;
+            }
+            call->bytes = 0;
+            for(int i = 0; i < call->count; i++){
+                err |= get_int(&at, &call->lengths[i]);
+                call->bytes += call->lengths[i];
+            }
+            break;
+        default:
+            err = -1;
+    }
+    call->fd -= 1;
+    return (err == -1) ? -1 : at;
+}
+
+// map_fd returns the slot of a recorded fd, or of a free slot for -1
+static int map_fd(int recorded){
+    for(int i = 0; i < TRACE_MAX_FDS; i++){
+        if((recorded == -1) ? fds[i].actual == -1 : (fds[i].actual != -1 && fds[i].recorded == recorded)){
+            return i;
+        }
+    }
+    return -1;
+}
+
+// the names a replayed list_dir finds aren't used
+static void ignore_name(char* name, void* arg){
+}
+
+static int replay_call(struct Test* test, struct TraceCall* call){
+    char* buf = test->params->buffer;
+    int slot = -1;
+    int fd = -1;
+    if(call->op >= TRACE_WRITE_AT && call->op <= TRACE_READV_AT){
+        if((slot = map_fd(call->fd)) == -1){
+            return -1;
+        }
+        fd = fds[slot].actual;
+    }
+    switch(call->op){
+        case TRACE_CREATE_FILE:
+            return API_CALL(test->api, create_file)(call->name);
+        case TRACE_DELETE_FILE:
+            return API_CALL(test->api, delete_file)(call->name);
+        case TRACE_CREATE_DIR:
+            return API_CALL(test->api, create_dir)(call->name);
+        case TRACE_DELETE_DIR:
+            return API_CALL(test->api, delete_dir)(call->name);
+        case TRACE_LIST_DIR:
+            return API_CALL(test->api, list_dir)(call->name, ignore_name, NULL);
+        case TRACE_OPEN:
+            fd = API_CALL(test->api, open_get_fd)(call->name);
+            if(call->fd != -1 && fd != -1 && (slot = map_fd(-1)) != -1){
+                fds[slot].recorded = call->fd;
+                fds[slot].actual = fd;
+            }
+            return (fd == -1) ? -1 : 0;
+        case TRACE_WRITE_AT:
+            return API_CALL(test->api, write_at)(fd, call->pos, call->bytes, buf);
+        case TRACE_READ_AT:
+            return API_CALL(test->api, read_at)(fd, call->pos, call->bytes, buf);
+        case TRACE_CLOSE:
+            fds[slot].actual = -1;
+            return API_CALL(test->api, close_fd)(fd);
+        case TRACE_APPEND:
+            return API_CALL(test->api, append)(fd, call->bytes, buf);
+        case TRACE_READ_NEXT:
+            return API_CALL(test->api, read_next)(fd, call->bytes, buf);
+        case TRACE_FLUSH:
+            return API_CALL(test->api, flush)(fd);
+    }
+    struct IOVec* vecs = test->params->vecs;
+    for(int i = 0; i < call->count; i++){
+        vecs[i].buf = buf;
+        vecs[i].bytes = call->lengths[i];
+        buf += call->lengths[i];
+    }
+    if(call->op == TRACE_WRITEV_AT){
+        return API_CALL(test->api, writev_at)(fd, call->pos, vecs, call->count);
+    }
+    return API_CALL(test->api, readv_at)(fd, call->pos, vecs, call->count);
+}
+
+/*
+trace_prepare sizes the buffer for the largest call in the trace
+*/
+int trace_prepare(struct Test* test){
+    struct TraceCall call;
+    int buffer = 1;
+    for(int at = 0; (at = trace_next(at, &call)) != -1;){
+        if(call.bytes > buffer){
+            buffer = call.bytes;
+        }
+    }
+    test->params = new_test_params();
+    if(test->params == NULL){
+        return -1;
+    }
+    void* t = arena_alloc(buffer);
+    test->params->buffer = (char*)t;
+    t = arena_alloc(sizeof(struct IOVec) * TRACE_MAX_VECS);
+    test->params->vecs = (struct IOVec*)t;
+    if(arena_peak() > ARENA_SIZE){
+        return -1;
+    }
+    datagen_fill(test->params->buffer, buffer);
+    for(int i = 0; i < TRACE_MAX_FDS; i++){
+        fds[i].actual = -1;
+    }
+    replayed = 0;
+    failed = 0;
+    return 0;
+}
+
+int trace_run(struct Test* test){
+    struct TraceCall call;
+    for(int at = 0; (at = trace_next(at, &call)) != -1;){
+        if(replay_call(test, &call) == -1){
+            failed++;
+        }
+        replayed++;
+    }
+    return 0;
+}
+
+// files the trace left open are closed here
+int trace_teardown(struct Test* test){
+    for(int i = 0; i < TRACE_MAX_FDS; i++){
+        if(fds[i].actual != -1){
+            API_CALL(test->api, close_fd)(fds[i].actual);
+            fds[i].actual = -1;
+        }
+    }
+    printf("trace: %d calls replayed, %d failed\n", replayed, failed);
+    test->params = NULL;
+    return 0;
+}
+
+/*
+trace_replay_process replays the trace with its original timing on the
+api given as its data
+*/
+PROCESS(trace_replay_process, "Trace replay process");
+PROCESS_THREAD(trace_replay_process, ev, data){
+    static struct Test* test;
+    static struct etimer et;
+    static struct TraceCall call;
+    static clock_time_t start;
+    static clock_time_t due;
+    static int at;
+    PROCESS_BEGIN();
+    test = TraceReplay;
+    test->api = (struct API*)data;
+    API_CALL(test->api, init)();
+    arena_reset();
+    if(trace_prepare(test) == -1){
+        log_error("trace replay does not fit in the arena");
+        test->params = NULL;
+        PROCESS_EXIT();
+    }
+    printf("run: %s on %s, original timing\n", test->name, test->api->name);
+    start = clock_time();
+    due = start;
+    at = 0;
+    while((at = trace_next(at, &call)) != -1){
+        due += call.delta;
+        clock_time_t wait = due - clock_time();
+        if(wait != 0 && wait < (clock_time_t)~0 / 2){
+            etimer_set(&et, wait);
+            PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+        }
+        if(replay_call(test, &call) == -1){
+            failed++;
+        }
+        replayed++;
+    }
+    printf("trace: replay took %u ticks\n", (unsigned int)(clock_time() - start));
+    trace_teardown(test);
+    PROCESS_END();
+}
@@ -0,0 +1,95 @@
+/*
+trace.c records the calls made to a backend into a compact binary trace
+and replays a trace against any backend.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_TRACE_H
+#define WATZBENCH_TRACE_H
+#include "contiki.h"
+#include "api.h"
+#include "common.h"
+
+// Bytes of trace kept in ram
+#ifdef TRACE_CONF_SIZE
+#define TRACE_SIZE TRACE_CONF_SIZE
+#else
+#define TRACE_SIZE 1024
+#endif
+
+// Files a replay can have open at once
+#ifdef TRACE_CONF_MAX_FDS
+#define TRACE_MAX_FDS TRACE_CONF_MAX_FDS
+#else
+#define TRACE_MAX_FDS 8
+#endif
+
+// Buffers of a vectored call, larger calls are recorded as single calls
+#define TRACE_MAX_VECS 16
+#define TRACE_NAME_SIZE 16
+
+// Operations, in the order of struct API
+#define TRACE_CREATE_FILE 1
+#define TRACE_DELETE_FILE 2
+#define TRACE_CREATE_DIR 3
+#define TRACE_DELETE_DIR 4
+#define TRACE_OPEN 5
+#define TRACE_WRITE_AT 6
+#define TRACE_READ_AT 7
+#define TRACE_CLOSE 8
+#define TRACE_APPEND 9
+#define TRACE_READ_NEXT 10
+#define TRACE_FLUSH 11
+#define TRACE_WRITEV_AT 12
+#define TRACE_READV_AT 13
+#define TRACE_LIST_DIR 14
+
+/*
+TraceCall is one decoded call. delta is the clock ticks since the call
+before it, fd is the fd the recorded backend used.
+*/
+struct TraceCall{
+    unsigned char op;
+    unsigned long delta;
+    int fd;
+    int pos;
+    int bytes;
+    int count;
+    int lengths[TRACE_MAX_VECS];
+    char name[TRACE_NAME_SIZE];
+};
+
+extern struct API* Traced;
+
+PROCESS_NAME(trace_replay_process);
+
+void trace_attach(struct API*);
+void trace_clear();
+void trace_dump();
+int trace_load(char* hex);
+int trace_static_ram();
+
+void traced_init();
+int traced_create_file(char*);
+int traced_delete_file(char*);
+int traced_create_dir(char*);
+int traced_delete_dir(char*);
+int traced_open_get_fd(char*);
+int traced_write_at(int, int, int, char*);
+int traced_read_at(int, int, int, char*);
+int traced_close_fd(int);
+int traced_append(int, int, char*);
+int traced_read_next(int, int, char*);
+int traced_flush(int);
+int traced_writev_at(int, int, struct IOVec*, int);
+int traced_readv_at(int, int, struct IOVec*, int);
+int traced_list_dir(char*, void (*)(char*, void*), void*);
+
+struct Test;
+
+int trace_prepare(struct Test* test);
+int trace_run(struct Test* test);
+int trace_teardown(struct Test* test);
+
+#endif //WATZBENCH_TRACE_H
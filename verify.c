@@ -0,0 +1,132 @@
+/*
+verify.c checks that reads return what was written.
+
+with VERIFY set, the job tests fill the buffer before every write with
+bytes derived from the file and the offset they go to, and check every
+read against the bytes that should be at its offset. a read is checked by
+comparing the crc16 (ccitt, table driven) of what came back with the crc
+of what should have, so no second buffer is needed. a read that returns
+fewer bytes than asked is short, one whose crc differs is a mismatch.
+
+filling and checking take time inside the timed region, so it is counted
+in rtimer ticks and printed on its own line after the test, to take out of
+the run time. with VERIFY at 0 none of this happens and the buffer holds
+DATA_KIND data as usual.
+*/
+#include "verify.h"
+
+static const unsigned short crc_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+static THREAD_LOCAL unsigned long checked;
+static THREAD_LOCAL unsigned long bytes_checked;
+static THREAD_LOCAL unsigned long mismatched;
+static THREAD_LOCAL unsigned long short_reads;
+static THREAD_LOCAL unsigned long ticks;
+
+/*
+pattern_byte is the byte at pos of the file with key. the high bits of
+pos are folded in, so a read from the wrong 256 byte block doesn't match.
+*/
+static unsigned char pattern_byte(int key, int pos){
+    return (unsigned char)(pos + (pos >> 8) * 7 + (pos >> 16) * 11 + key * 13);
+}
+
+static unsigned short crc_byte(unsigned short crc, unsigned char b){
+    return (crc << 8) ^ crc_table[(crc >> 8) ^ b];
+}
+
+unsigned short verify_crc(unsigned short crc, const unsigned char* data, int bytes){
+    for(int i = 0; i < bytes; i++){
+        crc = crc_byte(crc, data[i]);
+    }
+    return crc;
+}
+
+/*
+verify_fill fills buf with the bytes that belong at pos of the file with key
+*/
+void verify_fill(char* buf, int key, int pos, int bytes){
+    rtimer_clock_t start = RTIMER_NOW();
+    for(int i = 0; i < bytes; i++){
+        buf[i] = pattern_byte(key, pos + i);
+    }
+    ticks += (rtimer_clock_t)(RTIMER_NOW() - start);
+}
+
+/*
+verify_check checks a read of bytes at pos that returned got, it returns
+-1 for a short or mismatched read
+*/
+int verify_check(char* buf, int key, int pos, int bytes, int got){
+    rtimer_clock_t start = RTIMER_NOW();
+    int err = 0;
+    checked++;
+    if(got < bytes){
+        short_reads++;
+        err = -1;
+    }else{
+        unsigned short expected = 0xFFFF;
+        for(int i = 0; i < bytes; i++){
+            expected = crc_byte(expected, pattern_byte(key, pos + i));
+        }
+        if(verify_crc(0xFFFF, (unsigned char*)buf, bytes) != expected){
+            mismatched++;
+            err = -1;
+        }
+        bytes_checked += bytes;
+    }
+    ticks += (rtimer_clock_t)(RTIMER_NOW() - start);
+    return err;
+}
+
+void verify_reset(){
+    checked = 0;
+    bytes_checked = 0;
+    mismatched = 0;
+    short_reads = 0;
+    ticks = 0;
+}
+
+void verify_print(){
+    if(!VERIFY){
+        return;
+    }
+    printf("verify: %lu reads, %lu bytes checked, %lu mismatched, %lu short, overhead %lu ticks\n",
+        checked, bytes_checked, mismatched, short_reads, ticks);
+    if(mismatched > 0 || short_reads > 0){
+        log_error("verify: reads didn't return what was written");
+    }
+}
@@ -0,0 +1,21 @@
+/*
+verify.c checks that reads return what was written, with a crc.
+
+additional information and descriptions are in the c file
+*/
+
+#ifndef WATZBENCH_VERIFY_H
+#define WATZBENCH_VERIFY_H
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "common.h"
+
+extern int VERIFY;
+
+unsigned short verify_crc(unsigned short crc, const unsigned char* data, int bytes);
+void verify_fill(char* buf, int key, int pos, int bytes);
+int verify_check(char* buf, int key, int pos, int bytes, int got);
+void verify_reset();
+void verify_print();
+
+#endif //WATZBENCH_VERIFY_H
@@ -4,8 +4,96 @@ Contiki operating system.
 
 components:
 api.c/h: the interface between watzbench and various filesystems
+logfs.c/h: a log-structured, append-only backend
+async.c/h: split-phase front end for the api
+pattern.c/h: precomputed access patterns
+datagen.c/h: the data tests write
+verify.c/h: crc checks of what reads return
+archive.c/h: time indexed archive and its queries
+database.c/h: antelope database tests, make ANTELOPE=1 only
+histogram.c/h: latency distributions
+job.c/h: table-driven workloads, most tests are jobs
+arena.c/h: static allocator for test parameters and buffers
+footprint.c/h: stack high-water measurement
+energy.c/h: energest based energy accounting
+journal.c/h: results kept in flash across reboots
+console.c/h: serial line commands to run tests
+trace.c/h: capture and replay of api call streams
+instrument.c/h: cost of each api call
+compress.c/h: compression of archival data
+params.c/h: the parameters the console can set
 test.c/h: tests defined using the interfaces provided by the API
 common.c/h: useful functions used throughout watzbench 
+posix.c/h: pread/pwrite backend, host build only
+ring.c/h: batching io_uring backend, host build only
+scale.c/h: tests on several threads at once, host build only
+host/: contiki shims for the linux host build (make -f Makefile.host)
+run-matrix.sh: runs a matrix of tests as parallel processes
+
+tests are run from the console. the old example usage, as commands:
+  set WRITE_BYTES 256
+  run ArchivalStorage Coffee
+  run ArchivalStorage LogFS
+  stats
+  set WRITE_BYTES 1024
+  run ThroughputSeqWrite Coffee
+  run ThroughputStreamWrite Coffee
+  set BUFFER 16
+  run ThroughputSeqWrite Null
+  set BUFFER 128
+  sweep FLUSH_INTERVAL 1 16 x4 DurabilityFlush LogFS
+  set FLUSH_INTERVAL 0
+  run DurabilityFlush LogFS
+  set BATCH_RECORDS 1
+  sweep RECORD_SIZE 8 256 x2 BatchRecordWrite Coffee
+  set BATCH_RECORDS 16
+  sweep RECORD_SIZE 8 256 x2 BatchRecordWrite Coffee
+  set RECORD_SIZE 32
+  run MixedWorkload Coffee
+  async Coffee
+  trace start Coffee
+  run MixedWorkload Traced
+  trace replay LogFS
+  trace replay Coffee timed
+  set WRITE_BYTES 512
+  instrument Coffee
+  run ArchivalStorage Instrumented
+  run ArchivalStorage Coffee
+  compress Coffee
+  run ArchivalStorage Compressed
+  set DATA_KIND 2
+  set COMPRESS_MODE 2
+  run ArchivalStorage Compressed
+  set VERIFY 1
+  run ThroughputRandRead LogFS
+  run ArchiveQuery Coffee
+  set ARCHIVE_INDEX_EVERY 64
+  run ArchiveQuery Coffee
+
+how listing the root scales with the number of files, the LogFS file
+table holds LOGFS_MAX_FILES (101) unless raised in project-conf.h:
+  sweep DIR_FILES 10 1000 x10 DirList Coffee
+  set DIR_FILES 100
+  run DirDelete LogFS
+
+built with make ANTELOPE=1, the database against plain files:
+  run DbInsert Coffee
+  run SensorIngest Coffee
+  run DbRange Coffee
+  run ArchiveQuery Coffee
+
+on the host build, the batching of the Ring backend against Posix:
+  set INGEST_SENSORS 200
+  set RECORD_SIZE 16
+  run SensorIngest Posix
+  sweep RING_DEPTH 1 256 x2 SensorIngest Ring
+  set RING_POOL 1
+  sweep RING_DEPTH 1 256 x2 SensorIngest Ring
+
+and how Posix scales with concurrent writers, 1 to the number of cores:
+  scale SensorIngest
+  set SCALE_SHARED 1
+  scale ThroughputSeqWrite
 
 UCSC - CMPE259 - Spring 2017 - Cole Grim
  */
@@ -13,6 +101,15 @@ UCSC - CMPE259 - Spring 2017 - Cole Grim
 #include "contiki.h"
 #include "api.h"
 #include "test.h"
+#include "async.h"
+#include "journal.h"
+#include "console.h"
+#include "params.h"
+#include "compress.h"
+#include "trace.h"
+#include "instrument.h"
+#include "verify.h"
+#include "archive.h"
 #include "common.h"
 
 // Testing Parameters
@@ -20,15 +117,47 @@ const int FILES_TO_CREATE = 100; // The maximum number of files to create
 const int MAX_FILENAME_SIZE = 10; // Max number of characters in a filename (size of buffer)
 int WRITE_BYTES = 1024; // Max filesize to write
 int BUFFER = 128;   // Size of buffer
+int FLUSH_INTERVAL = 1; // Records appended between flushes (0 = never flush)
+int RECORD_SIZE = 32; // Size of a record in the batching tests
+int BATCH_RECORDS = 16; // Records per vectored call (1 = one write_at per record)
+int ACCESS_PATTERN = PATTERN_UNIFORM; // Offsets used by the random tests
+int ACCESS_SEED = 1; // Seed for ACCESS_PATTERN, the same seed gives the same offsets
+int ACCESS_STRIDE = 256; // Stride in bytes for PATTERN_STRIDE
+int MIX_WRITE_PERCENT = 70; // Share of writes in the mixed workload
+int MIX_WORKING_SET = 4096; // Size of the file the mixed workload works on
+int MIX_OPS = 200; // Operations in the mixed workload
+int INGEST_SENSORS = 4; // Files the ingest test appends to, each is open throughout
+int DIR_FILES = 100; // Files the directory tests create in the root
+int DATA_KIND = DATA_CONSTANT; // What the written buffers hold
+int DATA_SEED = 1; // Seed for DATA_KIND, the same seed gives the same bytes
+int VERIFY = 0; // Write offset patterns and check reads against them, see verify.c
+int ARCHIVE_INTERVAL = 60; // Seconds between the records of the ArchiveQuery day
+int ARCHIVE_INDEX_EVERY = 16; // Archive records per index entry
+int ARCHIVE_RECENT = 15; // Minutes the recent archive query covers
+#ifdef WATZBENCH_ANTELOPE
+int DB_ROWS = 200; // Rows of the database tests, one per minute
+int DB_RANGE = 15; // Rows a range select covers
+#endif
+int COMPRESS_MODE = COMPRESS_LZ; // Compressor of the Compressed backend
+#ifdef WATZBENCH_HOST
+int POSIX_DIRECT = 0; // Open Posix files with O_DIRECT
+int POSIX_SYNC = POSIX_SYNC_FLUSH; // When the Posix backend syncs to the device
+int RING_DEPTH = 32; // Writes the Ring backend submits at once
+int RING_POOL = 0; // Use the Ring thread pool even where io_uring works
+int SCALE_SHARED = 0; // Scale threads use the same files instead of one namespace each
+#endif
 
 // Program Options
 const int DEBUGGING_ENABLED = 1; // Debugging messages
-const int POWER_TESTS = 1; // enable or disable power consumption tests
+const int POWER_TESTS = 1; // enable or disable energy accounting of tests
 
 void init(){
     log_info("program starting");
+    init_params();
     init_api();
     init_test();
+    init_async();
+    init_journal();
 }
 
 void cleanup(){
@@ -45,13 +174,27 @@ PROCESS_THREAD(watzbench_process, ev, data) {
 
     printf("Beginning WatzBench.\n\n");
     printf("Important Device Information:\n");
-    printf("1 second = %lu ticks.\n\n", CLOCK_SECOND);
+    printf("1 second = %lu ticks.\n", CLOCK_SECOND);
+    printf("api dispatch: %s\n", API_DISPATCH);
+    printf("static ram: arena %d, %s %d, %s %d, %s %d, %s %d, %s %d, %s %d bytes\n\n",
+        ARENA_SIZE,
+        CFS->name, CFS->static_ram,
+        Coffee->name, Coffee->static_ram,
+        LogFS->name, LogFS->static_ram,
+        Traced->name, Traced->static_ram,
+        Compressed->name, Compressed->static_ram,
+        Instrumented->name, Instrumented->static_ram);
+#ifdef WATZBENCH_HOST
+    Ring->init();
+    printf("ring engine: %s\n\n", ring_engine());
+#endif
 
-    /* Example Usage */
-    WRITE_BYTES = 1024; // Write 1K files
-    BUFFER = 128;       // With a buffer of 128B
-    run_test(Coffee, ThroughputRandWrite);
+    process_start(&console_process, NULL);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_EXITED && data == &console_process);
 
     cleanup();
+#if defined(CONTIKI_TARGET_NATIVE) || defined(WATZBENCH_HOST)
+    exit(0);
+#endif
     PROCESS_END();
 }
\ No newline at end of file